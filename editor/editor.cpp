@@ -92,7 +92,7 @@ namespace __EDITOR__ {
     glViewport(0, 0, width, height);
   }
 
-  void CruxEditor::camera_editor(Transform& transform, Camera& camera, __RUNTIME__::SystemRenderer& renderer) {
+  void CruxEditor::camera_editor(LocalTransform& transform, Camera& camera, __RUNTIME__::SystemRenderer& renderer) {
     // ============================
     // CLAMP PITCH (ANTI GIMBAL LOCK)
     // ============================
@@ -159,6 +159,11 @@ namespace __EDITOR__ {
     World world;
     // InputSystem input = InputSystem(window);
 
+    //
+    // Distance buckets for Significance components; must run first.
+    //
+    world.add_system < __RUNTIME__::SignificanceSystem > ();
+
     //
     // Add the physics system to the world.
     // This system handles basic rigidbody integration and naive collision detection.
@@ -172,15 +177,18 @@ namespace __EDITOR__ {
     __RUNTIME__::SystemRenderer renderer = __RUNTIME__::SystemRenderer();
     renderer.is_editor_view = true;
 
+    // Workers for transform propagation
+    ThreadPool thread_pool;
+    renderer.thread_pool = &thread_pool;
+
     auto cube_entity = __TOOLS__::create_entities_from_obj(world, "./engine/assets/Mesh.obj");
     assert(world.alive(cube_entity));
-    world.add<Transform>(cube_entity);
+    __RUNTIME__::add_transform(world, cube_entity);
     
-    world.add<Identity>(cube_entity);
-    world.get<Identity>(cube_entity).name = "Cube";
+    world.emplace<Identity>(cube_entity, "Cube");
     
     auto cam = Camera();
-    auto camera_transform = Transform();
+    auto camera_transform = LocalTransform();
     camera_transform.position.z += 10;
 
     static bool was_right_mouse_button_clicked = false;
@@ -198,6 +206,7 @@ namespace __EDITOR__ {
     while (!glfwWindowShouldClose(window)) {
       // Call update deltatime
       Time::update_deltatime();
+      FrameAllocator::begin_frame();
 
       // Poll and handle user input events (keyword, mouse)
       glfwPollEvents();
@@ -209,6 +218,7 @@ namespace __EDITOR__ {
       // draw_main_menu_bar();
       // draw_viewport(state);
       // draw_hierarchy(world, nullptr);
+      draw_ecs_stats(world);
       ImGui::Render();
 
       int display_w, display_h;
@@ -268,8 +278,9 @@ namespace __EDITOR__ {
         glfwSetInputMode(window, GLFW_CURSOR, GLFW_CURSOR_NORMAL);
       }
 
-      auto& cube_transform = world.get<Transform>(cube_entity);
+      auto& cube_transform = world.get<LocalTransform>(cube_entity);
       cube_transform.rotation.x += 1.0f;
+      cube_transform.dirty = true;
 
       camera_editor(camera_transform, cam, renderer);
       float aspect = static_cast<float>(display_w) / static_cast<float>(display_h);
@@ -363,6 +374,23 @@ namespace __EDITOR__ {
   void CruxEditor::draw_hierarchy(World& world, Entity* selected) {
     ImGui::Begin("Hierarchy");
 
+    //
+    // Name search goes through the world's Identity index (no chunk scan).
+    //
+    static char search[128] = "";
+    ImGui::InputText("Search", search, sizeof(search));
+    if (search[0] != '\0') {
+      // find_interned: a name nobody has can't match, and typing must not
+      // fill the global string table with every prefix
+      Entity found = world.find_entity(find_interned(search));
+      if (found != Entity::invalid()) {
+        ImGui::Selectable(world.get<Identity>(found).name.c_str(), true);
+      } else {
+        ImGui::TextDisabled("No entity named '%s'", search);
+      }
+      ImGui::Separator();
+    }
+
     world.query().for_each_entity<Identity>(
     [&](Entity e, Identity& identity)
     {
@@ -382,4 +410,65 @@ namespace __EDITOR__ {
 
     ImGui::End();
   }
+
+  void CruxEditor::draw_ecs_stats(World& world) {
+    ImGui::Begin("ECS Stats");
+
+    WorldStats stats = world.stats();
+    ImGui::Text("%zu archetypes, %zu entities, %zu chunks",
+      stats.archetypes.size(), stats.entity_count, stats.chunk_count);
+    ImGui::Text("%.1f KB used / %.1f KB reserved",
+      stats.bytes_used / 1024.0, stats.bytes_reserved / 1024.0);
+    ImGui::Separator();
+
+    //
+    // One row per archetype; expand a row to see its column layout.
+    //
+    ImGuiTableFlags table_flags =
+      ImGuiTableFlags_Borders |
+      ImGuiTableFlags_RowBg   |
+      ImGuiTableFlags_Resizable;
+
+    if (ImGui::BeginTable("archetypes", 7, table_flags)) {
+      ImGui::TableSetupColumn("Archetype");
+      ImGui::TableSetupColumn("Entities");
+      ImGui::TableSetupColumn("Chunks");
+      ImGui::TableSetupColumn("Rows/Chunk");
+      ImGui::TableSetupColumn("Used / Reserved");
+      ImGui::TableSetupColumn("Padding");
+      ImGui::TableSetupColumn("Occupancy");
+      ImGui::TableHeadersRow();
+
+      for (std::size_t i = 0; i < stats.archetypes.size(); ++i) {
+        const ArchetypeStats& a = stats.archetypes[i];
+        ImGui::TableNextRow();
+
+        ImGui::TableNextColumn();
+        bool open = ImGui::TreeNode(&a, "#%zu (%zu components)", i, a.components.size());
+
+        ImGui::TableNextColumn(); ImGui::Text("%zu", a.entity_count);
+        ImGui::TableNextColumn(); ImGui::Text("%zu", a.chunk_count);
+        ImGui::TableNextColumn(); ImGui::Text("%zu", a.rows_per_chunk);
+        ImGui::TableNextColumn(); ImGui::Text("%zu / %zu", a.bytes_used, a.bytes_reserved);
+        ImGui::TableNextColumn(); ImGui::Text("%zu + %zu tail", a.padding_bytes, a.tail_bytes);
+        ImGui::TableNextColumn(); ImGui::ProgressBar(static_cast<float>(a.occupancy()));
+
+        if (open) {
+          for (const ColumnStats& c : a.columns) {
+            ImGui::TableNextRow();
+            ImGui::TableNextColumn();
+            ImGui::TextDisabled("%s", c.name);
+            ImGui::TableNextColumn(); ImGui::TextDisabled("size %zu", c.size);
+            ImGui::TableNextColumn(); ImGui::TextDisabled("align %zu", c.alignment);
+            ImGui::TableNextColumn(); ImGui::TextDisabled("offset %zu", c.offset);
+            ImGui::TableNextColumn(); ImGui::TextDisabled("%zu bytes", c.bytes);
+          }
+          ImGui::TreePop();
+        }
+      }
+      ImGui::EndTable();
+    }
+
+    ImGui::End();
+  }
 }
@@ -13,6 +13,7 @@
 
 #include <recs/world.h>
 #include <engine/core/physics_system.h>
+#include <engine/core/significance.h>
 #include <engine/core/render.h>
 #include <engine/core/camera.h>
 #include <engine/tools/load_object.h>
@@ -82,12 +83,13 @@ class CruxEditor {
   private:
   GLFWwindow* window;
 
-  void camera_editor(Transform& transform, Camera& camera, __RUNTIME__::SystemRenderer& renderer);
+  void camera_editor(LocalTransform& transform, Camera& camera, __RUNTIME__::SystemRenderer& renderer);
 
   void draw_editor_dockspace();
   void draw_main_menu_bar();
   void draw_viewport(EditorState& state);
   void draw_hierarchy(World& world, Entity* selected);
+  void draw_ecs_stats(World& world);
 };
 
 };
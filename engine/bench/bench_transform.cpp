@@ -0,0 +1,511 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <new>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include "recs/thread_pool.h"
+#include "recs/world.h"
+#include "recs/world_host.h"
+
+#include "engine/core/frame_allocator.h"
+#include "engine/core/frustum_cull.h"
+#include "engine/core/transform.h"
+#include "engine/core/transform_system.h"
+#include "engine/core/trs_kernel.h"
+
+//
+// crux_bench
+//
+// Benchmarks for engine hot paths that do not need a GL context: the TRS
+// kernel and transform propagation over flat, deep and wide hierarchies
+// (time per entity and heap allocations per frame). Results are written
+// as JSON to stdout (progress goes to stderr), in the same format as
+// resc_bench.
+//
+// Kernel correctness checks run first; a failing check exits with status 1
+// before anything is timed. `--check` runs only the checks.
+//
+// Usage: crux_bench [--check] [--sizes 10000,100000,...] [--runs N]
+//
+
+// Every heap allocation in the process goes through these, so a benchmark
+// can report how many a frame makes.
+static std::atomic<std::size_t> heap_allocations{ 0 };
+
+[[gnu::noinline]] void* operator new(std::size_t size) {
+  heap_allocations.fetch_add(1, std::memory_order_relaxed);
+  if (void* p = std::malloc(size ? size : 1)) return p;
+  throw std::bad_alloc();
+}
+
+[[gnu::noinline]] void* operator new(std::size_t size, std::align_val_t align) {
+  heap_allocations.fetch_add(1, std::memory_order_relaxed);
+  std::size_t a = static_cast<std::size_t>(align);
+  if (void* p = std::aligned_alloc(a, (size + a - 1) / a * a)) return p;
+  throw std::bad_alloc();
+}
+
+[[gnu::noinline]] void operator delete(void* p) noexcept { std::free(p); }
+[[gnu::noinline]] void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+[[gnu::noinline]] void operator delete(void* p, std::align_val_t) noexcept { std::free(p); }
+[[gnu::noinline]] void operator delete(void* p, std::size_t, std::align_val_t) noexcept { std::free(p); }
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+struct Result {
+  std::string name;
+  std::size_t entities;
+  double total_ns;
+  double allocs_per_frame = -1.0;  // only for the propagation benchmarks
+};
+
+std::vector<Result> results;
+volatile float sink = 0.0f;
+
+template<typename Func>
+double best_ns(int runs, Func&& fn) {
+  double best = 0.0;
+  for (int r = 0; r < runs; ++r) {
+    auto start = Clock::now();
+    fn();
+    double t = std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+    if (r == 0 || t < best) best = t;
+  }
+  return best;
+}
+
+void record(const char* name, std::size_t n, double ns, double allocs = -1.0) {
+  results.push_back({ name, n, ns, allocs });
+  std::fprintf(stderr, "  %-22s %10zu  %8.2f ns/entity", name, n, ns / double(n));
+  if (allocs >= 0.0) std::fprintf(stderr, "  %8.1f allocs/frame", allocs);
+  std::fprintf(stderr, "\n");
+}
+
+// The per-entity glm path local matrices were built with before the kernel
+glm::mat4 compose_glm(const LocalTransform& t) {
+  glm::mat4 m(1.0f);
+  m = glm::translate(m, t.position);
+  m = glm::rotate(m, glm::radians(t.rotation.x), glm::vec3(1,0,0));
+  m = glm::rotate(m, glm::radians(t.rotation.y), glm::vec3(0,1,0));
+  m = glm::rotate(m, glm::radians(t.rotation.z), glm::vec3(0,0,1));
+  m = glm::scale(m, t.scale);
+  return m;
+}
+
+std::vector<LocalTransform> random_transforms(std::size_t n) {
+  std::mt19937 rng(1234);
+  std::uniform_real_distribution<float> pos(-100.0f, 100.0f);
+  std::uniform_real_distribution<float> rot(-180.0f, 180.0f);
+  std::uniform_real_distribution<float> scl(0.5f, 2.0f);
+
+  std::vector<LocalTransform> transforms(n);
+  for (LocalTransform& t : transforms) {
+    t.position = { pos(rng), pos(rng), pos(rng) };
+    t.rotation = { rot(rng), rot(rng), rot(rng) };
+    t.scale = { scl(rng), scl(rng), scl(rng) };
+  }
+  return transforms;
+}
+
+// Kernel correctness, run before any timing so a wrong kernel can't post a
+// number: compose_trs (batched, with a remainder past the widest lane
+// count, and single) against T * Rx * Ry * Rz * S evaluated in double
+// precision. Returns false and reports the worst element on a mismatch.
+bool check_trs() {
+  constexpr double TOLERANCE = 1e-5;  // relative, floored at 1
+  constexpr std::size_t COUNT = 1027;
+
+  std::vector<LocalTransform> transforms = random_transforms(COUNT);
+  std::mt19937 rng(99);
+  std::uniform_real_distribution<float> turns(-720.0f, 720.0f);
+  for (std::size_t i = 0; i < COUNT; i += 3) transforms[i].rotation = { turns(rng), turns(rng), turns(rng) };
+  transforms[1].rotation = { 90.0f, -180.0f, 270.0f };  // exact quadrant edges
+
+  std::vector<LocalMatrix> batched(COUNT);
+  compose_trs(trs_batch(transforms.data(), batched.data()), COUNT);
+
+  double worst = 0.0;
+  std::size_t worst_index = 0;
+  for (std::size_t i = 0; i < COUNT; ++i) {
+    const LocalTransform& t = transforms[i];
+    const double rad = 0.017453292519943295;
+    const double sx = std::sin(t.rotation.x * rad), cx = std::cos(t.rotation.x * rad);
+    const double sy = std::sin(t.rotation.y * rad), cy = std::cos(t.rotation.y * rad);
+    const double sz = std::sin(t.rotation.z * rad), cz = std::cos(t.rotation.z * rad);
+
+    // Rx * Ry * Rz, row-major r[row][col]
+    const double r[3][3] = {
+      { cy * cz,                 -cy * sz,                 sy      },
+      { sx * sy * cz + cx * sz,  -sx * sy * sz + cx * cz,  -sx * cy },
+      { -cx * sy * cz + sx * sz, cx * sy * sz + sx * cz,   cx * cy  },
+    };
+    const double scale[3] = { t.scale.x, t.scale.y, t.scale.z };
+    const double position[3] = { t.position.x, t.position.y, t.position.z };
+
+    const glm::mat4 single = compose_local(t);
+    for (int col = 0; col < 4; ++col) {
+      for (int row = 0; row < 4; ++row) {
+        double expected;
+        if (col < 3) expected = row < 3 ? r[row][col] * scale[col] : 0.0;
+        else expected = row < 3 ? position[row] : 1.0;
+
+        const double scale_of_error = std::max(1.0, std::abs(expected));
+        const double err = std::max(std::abs(batched[i].value[col][row] - expected),
+                                    std::abs(single[col][row] - expected)) / scale_of_error;
+        if (err > worst) {
+          worst = err;
+          worst_index = i;
+        }
+      }
+    }
+  }
+
+  std::fprintf(stderr, "[crux] check compose_trs: max relative error %.3g\n", worst);
+  if (worst > TOLERANCE) {
+    const LocalTransform& t = transforms[worst_index];
+    std::fprintf(stderr,
+                 "[crux] FAILED compose_trs: error %.3g > %.0e at transform %zu "
+                 "(rotation %g %g %g)\n",
+                 worst, TOLERANCE, worst_index, t.rotation.x, t.rotation.y, t.rotation.z);
+    return false;
+  }
+  return true;
+}
+
+// cull_spheres (batched, strided like a component array, with a remainder
+// past the widest lane count) against the per-sphere plane test in double
+// precision. Spheres within 1e-4 of touching a plane are skipped: float
+// rounding may legitimately decide those either way. Spheres with a NaN
+// must be culled.
+bool check_cull_spheres() {
+  constexpr std::size_t COUNT = 4099;
+
+  struct Bounds {
+    float center[3];
+    float radius;
+    std::uint8_t visible;
+  };
+
+  const glm::mat4 view_proj =
+    glm::perspective(glm::radians(60.0f), 16.0f / 9.0f, 0.1f, 200.0f) *
+    glm::lookAt(glm::vec3(3.0f, 2.0f, 10.0f), glm::vec3(0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+  const Frustum frustum = Frustum::from_matrix(view_proj);
+
+  std::mt19937 rng(7);
+  std::uniform_real_distribution<float> pos(-150.0f, 150.0f);
+  std::uniform_real_distribution<float> rad(0.0f, 20.0f);
+  std::vector<Bounds> bounds(COUNT);
+  for (Bounds& b : bounds) {
+    b = { { pos(rng), pos(rng), pos(rng) }, rad(rng), 2 };
+  }
+  // NaN spheres are culled, in a vector batch and in the remainder alike
+  const float nan = std::numeric_limits<float>::quiet_NaN();
+  bounds[5].center[1] = nan;
+  bounds[COUNT - 1].radius = nan;
+
+  SphereBatch batch;
+  batch.sphere = bounds[0].center;
+  batch.in_stride = sizeof(Bounds) / sizeof(float);
+  batch.visible = &bounds[0].visible;
+  batch.out_stride = sizeof(Bounds);
+  const std::size_t reported = cull_spheres(frustum, batch, COUNT);
+
+  std::size_t mismatches = 0, flagged = 0, compared = 0;
+  for (const Bounds& b : bounds) {
+    flagged += b.visible == 1 ? 1 : 0;
+
+    bool inside = true, borderline = false;
+    for (const glm::vec4& p : frustum.planes) {
+      const double margin = double(p.x) * b.center[0] + double(p.y) * b.center[1] +
+                            double(p.z) * b.center[2] + double(p.w) + double(b.radius);
+      if (std::abs(margin) < 1e-4) borderline = true;
+      if (!(margin >= 0.0)) inside = false;
+    }
+    if (b.visible > 1) ++mismatches;  // never written
+    if (borderline) continue;
+    ++compared;
+    if (b.visible != (inside ? 1 : 0)) ++mismatches;
+  }
+  if (reported != flagged) ++mismatches;
+
+  std::fprintf(stderr, "[crux] check cull_spheres (%s): %zu visible, %zu compared, %zu mismatches\n",
+               cull_spheres_path(), flagged, compared, mismatches);
+  if (mismatches) {
+    std::fprintf(stderr, "[crux] FAILED cull_spheres: %zu results differ from the reference (returned %zu, flagged %zu)\n",
+                 mismatches, reported, flagged);
+    return false;
+  }
+  return true;
+}
+
+// TRS -> local matrix: the old glm code, the kernel one transform at a time
+// (compose_local) and the kernel over the whole array
+void bench_trs(std::size_t n, int runs) {
+  std::vector<LocalTransform> transforms = random_transforms(n);
+  std::vector<LocalMatrix> locals(n);
+
+  record("trs_glm", n, best_ns(runs, [&] {
+    for (std::size_t i = 0; i < n; ++i) locals[i].value = compose_glm(transforms[i]);
+    sink = locals[n / 2].value[3][0];
+  }));
+
+  record("trs_kernel_single", n, best_ns(runs, [&] {
+    for (std::size_t i = 0; i < n; ++i) locals[i].value = compose_local(transforms[i]);
+    sink = locals[n / 2].value[3][0];
+  }));
+
+  record("trs_kernel_batch", n, best_ns(runs, [&] {
+    compose_trs(trs_batch(transforms.data(), locals.data()), n);
+    sink = locals[n / 2].value[3][0];
+  }));
+}
+
+// Transform propagation (what SystemRenderer::update_system runs) over
+// three hierarchy shapes. Each frame moves the `movers`, so whole subtrees
+// are recomputed, then times propagate_transforms alone. The first frames
+// warm up both frame arenas.
+struct Scene {
+  World world;
+  std::vector<Entity> movers;
+};
+
+Entity spawn(World& world) {
+  Entity e = world.create_entity();
+  __RUNTIME__::add_transform(world, e);
+  world.get<LocalTransform>(e).rotation = { 10.0f, 20.0f, 30.0f };
+  return e;
+}
+
+void attach(World& world, Entity parent, Entity child) {
+  world.add<Family>(parent);
+  world.add<Family>(child);
+  world.get<Family>(parent).children.push_back(child);
+  world.get<Family>(child).parent = parent;
+}
+
+// n unrelated roots, all moving
+void build_flat(Scene& scene, std::size_t n) {
+  for (std::size_t i = 0; i < n; ++i) scene.movers.push_back(spawn(scene.world));
+}
+
+// Chains of DEPTH nodes; only the chain heads move
+void build_deep(Scene& scene, std::size_t n) {
+  constexpr std::size_t DEPTH = 1000;
+  for (std::size_t i = 0; i < n; i += DEPTH) {
+    Entity parent = spawn(scene.world);
+    scene.movers.push_back(parent);
+    for (std::size_t d = 1; d < DEPTH && i + d < n; ++d) {
+      Entity child = spawn(scene.world);
+      attach(scene.world, parent, child);
+      parent = child;
+    }
+  }
+}
+
+// One moving root with n - 1 direct children
+void build_wide(Scene& scene, std::size_t n) {
+  Entity root = spawn(scene.world);
+  scene.movers.push_back(root);
+  for (std::size_t i = 1; i < n; ++i) attach(scene.world, root, spawn(scene.world));
+}
+
+// Returns the time spent in propagate_transforms; `allocs` accumulates
+// the heap allocations it made.
+double propagation_frame(Scene& scene, ThreadPool* pool, std::size_t& allocs) {
+  FrameAllocator::begin_frame();
+  for (Entity e : scene.movers) {
+    LocalTransform& t = scene.world.get<LocalTransform>(e);
+    t.position.x += 0.01f;
+    t.dirty = true;
+  }
+
+  std::size_t before = heap_allocations.load();
+  auto start = Clock::now();
+  __RUNTIME__::propagate_transforms(scene.world, pool);
+  double ns = std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+  allocs += heap_allocations.load() - before;
+  return ns;
+}
+
+void bench_propagation_case(const char* name, Scene& scene, std::size_t n,
+                            ThreadPool* pool, int runs) {
+  std::size_t allocs = 0;
+  for (int i = 0; i < 4; ++i) propagation_frame(scene, pool, allocs);
+
+  allocs = 0;
+  double best = 0.0;
+  for (int r = 0; r < runs; ++r) {
+    double ns = propagation_frame(scene, pool, allocs);
+    if (r == 0 || ns < best) best = ns;
+  }
+  record(name, n, best, double(allocs) / double(runs));
+}
+
+void bench_propagation(std::size_t n, int runs, ThreadPool& pool) {
+  using Build = void (*)(Scene&, std::size_t);
+  struct Shape {
+    const char* serial;
+    const char* parallel;
+    Build build;
+  };
+  const Shape shapes[] = {
+    { "propagate_flat", "propagate_flat_mt", build_flat },
+    { "propagate_deep", "propagate_deep_mt", build_deep },
+    { "propagate_wide", "propagate_wide_mt", build_wide },
+  };
+
+  for (const Shape& shape : shapes) {
+    Scene scene;
+    shape.build(scene, n);
+    bench_propagation_case(shape.serial, scene, n, nullptr, runs);
+    bench_propagation_case(shape.parallel, scene, n, &pool, runs);
+  }
+
+  // Nothing moved: the cost of the dirty-flag scan alone
+  Scene scene;
+  build_flat(scene, n);
+  scene.movers.clear();
+  bench_propagation_case("propagate_static", scene, n, nullptr, runs);
+}
+
+// TransformSystem handed the WorldHost's own pool: every world's
+// propagation nests parallel_for inside the host's step. It must finish
+// (it deadlocked before parallel_for could run on a worker) and match a
+// serial pass over the same scene.
+bool check_transform_on_host() {
+  constexpr std::size_t WORLDS = 4;
+  constexpr std::size_t ROOTS = 64;
+  constexpr std::size_t CHILDREN = 16;
+
+  // Same creation order in every world, so the entity handles match
+  auto build = [](World& world, std::vector<Entity>& roots) {
+    for (std::size_t r = 0; r < ROOTS; ++r) {
+      Entity root = spawn(world);
+      roots.push_back(root);
+      for (std::size_t c = 0; c < CHILDREN; ++c) attach(world, root, spawn(world));
+    }
+  };
+  auto move = [](World& world, const std::vector<Entity>& roots) {
+    for (Entity root : roots) {
+      LocalTransform& t = world.get<LocalTransform>(root);
+      t.position.x += 1.0f;
+      t.rotation.y += 15.0f;
+      t.dirty = true;
+    }
+  };
+
+  World reference;
+  std::vector<Entity> reference_roots;
+  build(reference, reference_roots);
+
+  WorldHost host(2);
+  std::vector<std::vector<Entity>> roots(WORLDS);
+  for (std::size_t w = 0; w < WORLDS; ++w) {
+    World& world = host.create_world();
+    build(world, roots[w]);
+    world.add_system<__RUNTIME__::TransformSystem>(&host.thread_pool());
+  }
+
+  for (int frame = 0; frame < 3; ++frame) {
+    FrameAllocator::begin_frame();
+    move(reference, reference_roots);
+    __RUNTIME__::propagate_transforms(reference);
+    for (std::size_t w = 0; w < WORLDS; ++w) move(host.world(w), roots[w]);
+    host.step(1.0f / 60.0f);
+  }
+
+  std::size_t mismatches = 0;
+  reference.query().for_each_entity<WorldMatrix>([&](Entity e, WorldMatrix& expected) {
+    for (std::size_t w = 0; w < WORLDS; ++w) {
+      const glm::mat4& got = host.world(w).get<WorldMatrix>(e).value;
+      for (int col = 0; col < 4; ++col) {
+        for (int row = 0; row < 4; ++row) {
+          if (got[col][row] != expected.value[col][row]) ++mismatches;
+        }
+      }
+    }
+  });
+
+  std::fprintf(stderr, "[crux] check TransformSystem on the host pool: %zu mismatches\n", mismatches);
+  if (mismatches) {
+    std::fprintf(stderr, "[crux] FAILED TransformSystem on the host pool differs from a serial pass\n");
+    return false;
+  }
+  return true;
+}
+
+std::vector<std::size_t> parse_sizes(const char* arg) {
+  std::vector<std::size_t> sizes;
+  const char* start = arg;
+  while (*start) {
+    sizes.push_back(std::strtoull(start, nullptr, 10));
+    const char* comma = std::strchr(start, ',');
+    if (!comma) break;
+    start = comma + 1;
+  }
+  return sizes;
+}
+
+void write_json() {
+  std::printf("{\n  \"benchmarks\": [\n");
+  for (std::size_t i = 0; i < results.size(); ++i) {
+    const Result& r = results[i];
+    std::printf(
+      "    {\"name\": \"%s\", \"entities\": %zu, \"total_ns\": %.0f, \"ns_per_entity\": %.3f",
+      r.name.c_str(), r.entities, r.total_ns, r.total_ns / double(r.entities)
+    );
+    if (r.allocs_per_frame >= 0.0) std::printf(", \"allocs_per_frame\": %.1f", r.allocs_per_frame);
+    std::printf("}%s\n", i + 1 < results.size() ? "," : "");
+  }
+  std::printf("  ]\n}\n");
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+  std::vector<std::size_t> sizes = { 10'000, 100'000, 1'000'000 };
+  int runs = 5;
+  bool check_only = false;
+
+  for (int i = 1; i < argc; ++i) {
+    if (std::strcmp(argv[i], "--check") == 0) {
+      check_only = true;
+    } else if (std::strcmp(argv[i], "--sizes") == 0 && i + 1 < argc) {
+      sizes = parse_sizes(argv[++i]);
+    } else if (std::strcmp(argv[i], "--runs") == 0 && i + 1 < argc) {
+      runs = std::max(1, std::atoi(argv[++i]));
+    } else {
+      std::fprintf(stderr, "usage: %s [--check] [--sizes N,N,...] [--runs N]\n", argv[0]);
+      return 1;
+    }
+  }
+
+  ThreadPool pool;
+  std::fprintf(stderr, "[crux] TRS kernel path: %s, %zu workers\n",
+               compose_trs_path(), pool.worker_count());
+  if (!check_trs() || !check_cull_spheres() || !check_transform_on_host()) return 1;
+  if (check_only) return 0;
+
+  for (std::size_t n : sizes) {
+    if (n == 0) continue;
+    std::fprintf(stderr, "[crux] bench %zu entities\n", n);
+    bench_trs(n, runs);
+    bench_propagation(n, runs, pool);
+  }
+
+  write_json();
+  return 0;
+}
@@ -11,7 +11,7 @@
 // should participate in collisions can add a `Collider` component and
 // provide a `half_extents` vector describing the box extents in model/local
 // space. During collision tests we transform the AABB by the entity's
-// `Transform::position` (no rotation applied for AABB simplicity).
+// `LocalTransform::position` (no rotation applied for AABB simplicity).
 //
 // Note: This is intentionally minimal. For production use you would want
 // oriented boxes, collision layers, continuous collision, and a proper
@@ -0,0 +1,54 @@
+#pragma once
+
+#include "recs/world.h"
+#include "recs/thread_pool.h"
+#include "transform.h"
+#include "transform_system.h"
+#include "mesh.h"
+#include "frustum_cull.h"
+#include "frame_allocator.h"
+
+#include <atomic>
+#include <cstddef>
+#include <memory_resource>
+
+// cull_spheres view over a WorldBounds array
+inline SphereBatch sphere_batch(WorldBounds* bounds) {
+  SphereBatch batch;
+  batch.sphere = &bounds->center.x;
+  batch.in_stride = sizeof(WorldBounds) / sizeof(float);
+  batch.visible = &bounds->visible;
+  batch.out_stride = sizeof(WorldBounds);
+  return batch;
+}
+
+namespace __RUNTIME__ {
+
+// Frustum culling
+//
+// Runs the batched sphere test over each renderable chunk's WorldBounds
+// array (kept current by transform propagation), leaving `visible` set for
+// the entities inside `view_proj`'s frustum. Chunks are spread over `pool`
+// when there is one. Run after transform propagation; returns the number
+// of visible entities.
+inline std::size_t cull_renderables(World& world, const glm::mat4& view_proj, ThreadPool* pool = nullptr) {
+  const Frustum frustum = Frustum::from_matrix(view_proj);
+
+  std::pmr::vector<Chunk*> chunks(FrameAllocator::resource());
+  world.query<MeshRenderer, WorldBounds>()
+    .collect_chunks<MeshRenderer, WorldBounds>(chunks);
+
+  std::atomic<std::size_t> visible{ 0 };
+  run_batches(pool, chunks.size(), 1, [&](std::size_t begin, std::size_t end) {
+    std::size_t found = 0;
+    for (std::size_t c = begin; c < end; ++c) {
+      auto [bounds] = chunks[c]->get_arrays<WorldBounds>();
+      found += cull_spheres(frustum, sphere_batch(bounds), chunks[c]->size());
+    }
+    visible.fetch_add(found, std::memory_order_relaxed);
+  });
+
+  return visible.load(std::memory_order_relaxed);
+}
+
+} // namespace __RUNTIME__
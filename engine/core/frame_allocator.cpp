@@ -0,0 +1,92 @@
+#include "frame_allocator.h"
+
+#include <algorithm>
+#include <atomic>
+#include <new>
+
+FrameArena::~FrameArena() {
+  for (const Block& block : blocks) {
+    ::operator delete(block.memory, std::align_val_t(alignof(std::max_align_t)));
+  }
+}
+
+void FrameArena::reset() {
+  // Fold the blocks of a frame that overflowed into one big enough for it
+  if (blocks.size() > 1) {
+    std::size_t total = capacity;
+    for (const Block& block : blocks) {
+      ::operator delete(block.memory, std::align_val_t(alignof(std::max_align_t)));
+    }
+    blocks.clear();
+    capacity = 0;
+    add_block(total);
+  }
+
+  if (!blocks.empty()) {
+    cursor = blocks.front().memory;
+    end = cursor + blocks.front().size;
+  }
+  used = 0;
+}
+
+void FrameArena::add_block(std::size_t min_bytes) {
+  std::size_t size = std::max(min_bytes, DEFAULT_BLOCK);
+  auto* memory = static_cast<std::byte*>(
+    ::operator new(size, std::align_val_t(alignof(std::max_align_t)))
+  );
+  blocks.push_back({ memory, size });
+  capacity += size;
+  cursor = memory;
+  end = memory + size;
+}
+
+void* FrameArena::do_allocate(std::size_t bytes, std::size_t alignment) {
+  auto aligned = [&] {
+    auto address = reinterpret_cast<std::uintptr_t>(cursor);
+    return reinterpret_cast<std::byte*>((address + alignment - 1) & ~(alignment - 1));
+  };
+
+  std::byte* p = cursor ? aligned() : nullptr;
+  if (!p || p + bytes > end) {
+    add_block(bytes + alignment);
+    p = aligned();
+  }
+
+  cursor = p + bytes;
+  used += bytes;
+  return p;
+}
+
+namespace {
+
+std::atomic<std::uint64_t> current_frame{ 0 };
+
+struct ThreadArenas {
+  FrameArena arenas[2];
+  std::uint64_t frame[2] = { ~0ull, ~0ull };
+};
+
+thread_local ThreadArenas thread_arenas;
+
+} // namespace
+
+void FrameAllocator::begin_frame() {
+  current_frame.fetch_add(1, std::memory_order_release);
+}
+
+std::uint64_t FrameAllocator::frame_index() {
+  return current_frame.load(std::memory_order_acquire);
+}
+
+std::pmr::memory_resource* FrameAllocator::resource() {
+  std::uint64_t frame = frame_index();
+  ThreadArenas& t = thread_arenas;
+
+  // Arena `frame & 1` last served frame - 2, so it is free to rewind
+  std::size_t slot = frame & 1;
+  if (t.frame[slot] != frame) {
+    t.arenas[slot].reset();
+    t.frame[slot] = frame;
+  }
+  return &t.arenas[slot];
+}
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <vector>
+
+// FrameArena
+//
+// Bump allocator for data that only lives for a frame. Allocation moves a
+// pointer, deallocation does nothing, and reset() rewinds everything at
+// once. When a frame outgrows the current block another one is chained
+// on; the next reset() replaces them with a single block of the combined
+// size so steady-state frames allocate nothing from the system.
+class FrameArena : public std::pmr::memory_resource {
+public:
+  static constexpr std::size_t DEFAULT_BLOCK = 256 * 1024;
+
+  FrameArena() = default;
+  ~FrameArena() override;
+
+  FrameArena(const FrameArena&) = delete;
+  FrameArena& operator=(const FrameArena&) = delete;
+
+  void reset();
+
+  // Bytes handed out since the last reset / reserved from the system.
+  std::size_t used_bytes() const noexcept { return used; }
+  std::size_t capacity_bytes() const noexcept { return capacity; }
+
+private:
+  void* do_allocate(std::size_t bytes, std::size_t alignment) override;
+  void do_deallocate(void*, std::size_t, std::size_t) override {}
+  bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+    return this == &other;
+  }
+
+  void add_block(std::size_t min_bytes);
+
+  struct Block {
+    std::byte* memory;
+    std::size_t size;
+  };
+
+  std::vector<Block> blocks;
+  std::byte* cursor = nullptr;
+  std::byte* end = nullptr;
+  std::size_t used = 0;
+  std::size_t capacity = 0;
+};
+
+// FrameAllocator
+//
+// Per-thread, double-buffered frame arenas. `resource()` returns the calling
+// thread's arena for the current frame; memory taken from it stays valid
+// until the end of the *next* frame, so data can be handed from one frame
+// to the one after it (e.g. last frame's draw list). Arenas are rewound
+// lazily by their own thread, which keeps them lock-free.
+//
+// Typical use in a system:
+//
+//   std::pmr::vector<Item> items(FrameAllocator::resource());
+//
+// Do not keep frame memory in components or anything else that outlives
+// two frames.
+class FrameAllocator {
+public:
+  // Advance to the next frame. Call once per frame from the main loop,
+  // while no system is running.
+  static void begin_frame();
+
+  static std::uint64_t frame_index();
+
+  static std::pmr::memory_resource* resource();
+};
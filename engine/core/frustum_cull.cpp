@@ -0,0 +1,114 @@
+#include "frustum_cull.h"
+
+#include <bit>
+
+#if defined(__AVX2__)
+  #include <immintrin.h>
+  #define CRUX_CULL_AVX2 1
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+  #include <emmintrin.h>
+  #define CRUX_CULL_SSE2 1
+#endif
+
+namespace {
+
+// One sphere: inside unless fully behind some plane. Written as the
+// vector paths' ordered `>=`, so a NaN sphere is culled on every ISA.
+inline bool sphere_visible(const Frustum& f, const float* s) {
+  for (const glm::vec4& p : f.planes) {
+    if (!(p.x * s[0] + p.y * s[1] + p.z * s[2] + p.w >= -s[3])) return false;
+  }
+  return true;
+}
+
+#if defined(CRUX_CULL_SSE2)
+inline __m128 load4(const float* p, std::size_t stride) {
+  return _mm_setr_ps(p[0], p[stride], p[2 * stride], p[3 * stride]);
+}
+
+// Bit l set when sphere `first + l` is visible
+inline unsigned cull4(const Frustum& f, const SphereBatch& b, std::size_t first) {
+  const float* s = b.sphere + first * b.in_stride;
+  const __m128 x = load4(s + 0, b.in_stride);
+  const __m128 y = load4(s + 1, b.in_stride);
+  const __m128 z = load4(s + 2, b.in_stride);
+  const __m128 neg_r = _mm_xor_ps(load4(s + 3, b.in_stride), _mm_set1_ps(-0.0f));
+
+  __m128 inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+  for (const glm::vec4& p : f.planes) {
+    __m128 d = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(p.x), x), _mm_mul_ps(_mm_set1_ps(p.y), y));
+    d = _mm_add_ps(_mm_add_ps(d, _mm_mul_ps(_mm_set1_ps(p.z), z)), _mm_set1_ps(p.w));
+    inside = _mm_and_ps(inside, _mm_cmpge_ps(d, neg_r));
+  }
+  return static_cast<unsigned>(_mm_movemask_ps(inside));
+}
+#endif
+
+#if defined(CRUX_CULL_AVX2)
+inline __m256 load8(const float* p, std::size_t stride) {
+  const int s = static_cast<int>(stride);
+  __m256i index = _mm256_mullo_epi32(
+    _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7), _mm256_set1_epi32(s)
+  );
+  return _mm256_i32gather_ps(p, index, 4);
+}
+
+inline unsigned cull8(const Frustum& f, const SphereBatch& b, std::size_t first) {
+  const float* s = b.sphere + first * b.in_stride;
+  const __m256 x = load8(s + 0, b.in_stride);
+  const __m256 y = load8(s + 1, b.in_stride);
+  const __m256 z = load8(s + 2, b.in_stride);
+  const __m256 neg_r = _mm256_xor_ps(load8(s + 3, b.in_stride), _mm256_set1_ps(-0.0f));
+
+  __m256 inside = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+  for (const glm::vec4& p : f.planes) {
+    __m256 d = _mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(p.x), x), _mm256_mul_ps(_mm256_set1_ps(p.y), y));
+    d = _mm256_add_ps(_mm256_add_ps(d, _mm256_mul_ps(_mm256_set1_ps(p.z), z)), _mm256_set1_ps(p.w));
+    inside = _mm256_and_ps(inside, _mm256_cmp_ps(d, neg_r, _CMP_GE_OQ));
+  }
+  return static_cast<unsigned>(_mm256_movemask_ps(inside));
+}
+#endif
+
+// Spreads the low `lanes` bits of mask over the result bytes
+inline void write_mask(const SphereBatch& b, std::size_t first, unsigned mask, std::size_t lanes) {
+  for (std::size_t l = 0; l < lanes; ++l) {
+    b.visible[(first + l) * b.out_stride] = static_cast<std::uint8_t>((mask >> l) & 1u);
+  }
+}
+
+} // namespace
+
+std::size_t cull_spheres(const Frustum& frustum, const SphereBatch& batch, std::size_t count) {
+  std::size_t visible = 0;
+  std::size_t i = 0;
+#if defined(CRUX_CULL_AVX2)
+  for (; i + 8 <= count; i += 8) {
+    unsigned mask = cull8(frustum, batch, i);
+    write_mask(batch, i, mask, 8);
+    visible += static_cast<std::size_t>(std::popcount(mask));
+  }
+#elif defined(CRUX_CULL_SSE2)
+  for (; i + 4 <= count; i += 4) {
+    unsigned mask = cull4(frustum, batch, i);
+    write_mask(batch, i, mask, 4);
+    visible += static_cast<std::size_t>(std::popcount(mask));
+  }
+#endif
+  for (; i < count; ++i) {
+    bool v = sphere_visible(frustum, batch.sphere + i * batch.in_stride);
+    batch.visible[i * batch.out_stride] = v ? 1 : 0;
+    visible += v ? 1 : 0;
+  }
+  return visible;
+}
+
+const char* cull_spheres_path() {
+#if defined(CRUX_CULL_AVX2)
+  return "avx2";
+#elif defined(CRUX_CULL_SSE2)
+  return "sse2";
+#else
+  return "scalar";
+#endif
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include <glm/glm.hpp>
+
+// Batched frustum culling of bounding spheres
+//
+// Tests eight (AVX2) or four (SSE2) spheres against the six frustum planes
+// per step, so a chunk of renderables is culled in a handful of vector
+// operations per plane. Selection of the instruction set and the scalar
+// remainder work as in trs_kernel.h. `crux_bench --check` compares every
+// path against the per-sphere plane test.
+
+// Planes (n, d) with |n| = 1 and n . p + d >= 0 for points inside, in the
+// space of the matrix they were extracted from (world space for a
+// view-projection matrix).
+struct Frustum {
+  glm::vec4 planes[6];
+
+  // Gribb-Hartmann extraction for OpenGL clip space (-w <= z <= w)
+  static Frustum from_matrix(const glm::mat4& view_proj) {
+    auto row = [&](int r) {
+      return glm::vec4(view_proj[0][r], view_proj[1][r], view_proj[2][r], view_proj[3][r]);
+    };
+    const glm::vec4 x = row(0), y = row(1), z = row(2), w = row(3);
+
+    Frustum f;
+    f.planes[0] = w + x;  // left
+    f.planes[1] = w - x;  // right
+    f.planes[2] = w + y;  // bottom
+    f.planes[3] = w - y;  // top
+    f.planes[4] = w + z;  // near
+    f.planes[5] = w - z;  // far
+    for (glm::vec4& p : f.planes) {
+      p /= glm::length(glm::vec3(p));
+    }
+    return f;
+  }
+};
+
+// Strided view over sphere / flag arrays, so the kernel reads straight out
+// of component arrays: sphere i is the four floats (center xyz, radius) at
+// `sphere + i * in_stride` (in floats), its result byte is written to
+// `visible + i * out_stride` (in bytes): 1 if the sphere touches the
+// frustum, 0 otherwise (including spheres with a NaN in them).
+struct SphereBatch {
+  const float* sphere = nullptr;
+  std::size_t in_stride = 4;
+
+  std::uint8_t* visible = nullptr;
+  std::size_t out_stride = 1;
+};
+
+// Returns how many of the `count` spheres are visible.
+std::size_t cull_spheres(const Frustum& frustum, const SphereBatch& batch, std::size_t count);
+
+// Which path cull_spheres was compiled with: "avx2", "sse2" or "scalar".
+const char* cull_spheres_path();
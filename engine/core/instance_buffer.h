@@ -0,0 +1,65 @@
+#pragma once
+
+#include <cstddef>
+#include <utility>
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+// InstanceBuffer
+//
+// Streams the per-frame model matrices of instanced draws. Each upload
+// orphans the previous storage (glBufferData with no data) so the driver
+// never waits for last frame's draws to finish reading it; the buffer name
+// stays the same, only the attribute offsets change between batches (see
+// GpuMesh::draw_instanced).
+//
+// Created on the first upload; move-only.
+class InstanceBuffer {
+public:
+  InstanceBuffer() = default;
+
+  ~InstanceBuffer() {
+    if (vbo) glDeleteBuffers(1, &vbo);
+  }
+
+  InstanceBuffer(const InstanceBuffer&) = delete;
+  InstanceBuffer& operator=(const InstanceBuffer&) = delete;
+
+  InstanceBuffer(InstanceBuffer&& other) noexcept
+    : vbo(std::exchange(other.vbo, 0)),
+      capacity(std::exchange(other.capacity, 0)) {}
+
+  InstanceBuffer& operator=(InstanceBuffer&& other) noexcept {
+    if (this != &other) {
+      if (vbo) glDeleteBuffers(1, &vbo);
+      vbo = std::exchange(other.vbo, 0);
+      capacity = std::exchange(other.capacity, 0);
+    }
+    return *this;
+  }
+
+  void upload(const glm::mat4* matrices, std::size_t count) {
+    if (!vbo) glGenBuffers(1, &vbo);
+
+    // Grow geometrically so a slowly rising instance count does not
+    // reallocate every frame
+    if (count > capacity) {
+      capacity = capacity ? capacity : 1024;
+      while (capacity < count) capacity *= 2;
+    }
+
+    glBindBuffer(GL_ARRAY_BUFFER, vbo);
+    glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(capacity * sizeof(glm::mat4)), nullptr, GL_STREAM_DRAW);
+    if (count) {
+      glBufferSubData(GL_ARRAY_BUFFER, 0, static_cast<GLsizeiptr>(count * sizeof(glm::mat4)), matrices);
+    }
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+  }
+
+  GLuint id() const noexcept { return vbo; }
+
+private:
+  GLuint vbo = 0;
+  std::size_t capacity = 0;
+};
@@ -13,6 +13,13 @@ struct Material {
   float roughness = 0.5f;
   float ao = 0.2f;
 
+  // Set after changing any parameter above; the renderer looks the
+  // material's uniform block up again (see MaterialBuffer) and clears it
+  bool dirty = true;
+  // Slot in the renderer's material uniform buffer, assigned on first draw.
+  // Materials with equal parameters share one, and draw together.
+  std::uint32_t gpu_slot = UINT32_MAX;
+
   Material() = default;
   Material(uint32_t r, uint32_t g, uint32_t b, uint32_t a) : albedo_color({r, g, b}), opacity(a) {}
 };
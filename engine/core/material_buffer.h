@@ -0,0 +1,207 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include "recs/world.h"
+#include "recs/flat_hash_map.h"
+#include "material.h"
+
+// std140 image of the `MaterialBlock` uniform block:
+//
+//   layout(std140) uniform MaterialBlock {
+//     vec4 u_AlbedoOpacity;   // rgb albedo, a opacity
+//     vec4 u_Surface;         // metalic, normal, roughness, ao
+//   };
+struct MaterialBlock {
+  glm::vec4 albedo_opacity;
+  glm::vec4 surface;
+
+  static MaterialBlock from(const Material& m) {
+    return {
+      glm::vec4(m.albedo_color, m.opacity),
+      glm::vec4(m.metalic, m.normal, m.roughness, m.ao)
+    };
+  }
+
+  // Bitwise, so it agrees with Hash
+  bool operator==(const MaterialBlock& other) const noexcept {
+    return std::memcmp(this, &other, sizeof(MaterialBlock)) == 0;
+  }
+
+  struct Hash {
+    std::size_t operator()(const MaterialBlock& b) const noexcept {
+      return std::hash<std::string_view>()(
+        std::string_view(reinterpret_cast<const char*>(&b), sizeof(MaterialBlock)));
+    }
+  };
+};
+
+// MaterialBuffer
+//
+// One GL uniform buffer holding a MaterialBlock per distinct set of
+// material parameters, each in its own slot at
+// GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT stride. Materials with equal
+// parameters share a slot, which is what lets the renderer instance
+// entities that each carry their own Material component.
+//
+// `sync()` runs once per frame: materials that are new or flagged `dirty`
+// are looked up by value and get an existing slot or a freshly uploaded
+// one, and slots no material referenced this frame are recycled. A slot's
+// contents never change while it is in use. Drawing then just points the
+// binding at the material's slot, skipping the call when consecutive draws
+// share it.
+//
+// GL objects are created on the first sync, so it can be constructed
+// before a context exists. Move-only.
+class MaterialBuffer {
+public:
+  static constexpr GLuint BINDING = 0;
+
+  MaterialBuffer() = default;
+
+  ~MaterialBuffer() {
+    if (ubo) glDeleteBuffers(1, &ubo);
+  }
+
+  MaterialBuffer(const MaterialBuffer&) = delete;
+  MaterialBuffer& operator=(const MaterialBuffer&) = delete;
+
+  MaterialBuffer(MaterialBuffer&& other) noexcept { swap(other); }
+  MaterialBuffer& operator=(MaterialBuffer&& other) noexcept {
+    MaterialBuffer tmp(std::move(other));
+    swap(tmp);
+    return *this;
+  }
+
+  void sync(World& world) {
+    if (!ubo) create();
+    ++frame;
+    bound_slot = NO_SLOT;
+
+    glBindBuffer(GL_UNIFORM_BUFFER, ubo);
+    world.query<Material>().for_each<Material>([&](Material& m) {
+      if (m.dirty || m.gpu_slot >= last_seen.size() || last_seen[m.gpu_slot] == 0) {
+        m.gpu_slot = slot_for(MaterialBlock::from(m));
+        m.dirty = false;
+      }
+      last_seen[m.gpu_slot] = frame;
+    });
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+
+    // Slots no material points at anymore
+    for (std::uint32_t slot = 0; slot < last_seen.size(); ++slot) {
+      if (last_seen[slot] != 0 && last_seen[slot] != frame) {
+        last_seen[slot] = 0;
+        by_value.erase(contents[slot]);
+        free_slots.push_back(slot);
+      }
+    }
+  }
+
+  // Binds the material's block to BINDING; call after sync()
+  void bind(const Material& m) { bind(m.gpu_slot); }
+
+  void bind(std::uint32_t slot) {
+    if (slot == bound_slot) return;
+    glBindBufferRange(GL_UNIFORM_BUFFER, BINDING, ubo, slot_offset(slot), sizeof(MaterialBlock));
+    bound_slot = slot;
+  }
+
+  std::size_t slot_count() const noexcept { return last_seen.size() - free_slots.size(); }
+
+private:
+  static constexpr std::uint32_t NO_SLOT = UINT32_MAX;
+  static constexpr std::uint32_t INITIAL_SLOTS = 64;
+
+  GLintptr slot_offset(std::uint32_t slot) const {
+    return static_cast<GLintptr>(slot) * stride;
+  }
+
+  void create() {
+    GLint alignment = 256;
+    glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &alignment);
+    stride = (static_cast<GLsizeiptr>(sizeof(MaterialBlock)) + alignment - 1) / alignment * alignment;
+
+    glGenBuffers(1, &ubo);
+    glBindBuffer(GL_UNIFORM_BUFFER, ubo);
+    glBufferData(GL_UNIFORM_BUFFER, stride * INITIAL_SLOTS, nullptr, GL_DYNAMIC_DRAW);
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+    capacity = INITIAL_SLOTS;
+  }
+
+  // Slot holding `block`, uploading it to a new one if no live slot does.
+  // Expects the buffer bound to GL_UNIFORM_BUFFER.
+  std::uint32_t slot_for(const MaterialBlock& block) {
+    auto it = by_value.find(block);
+    if (it != by_value.end()) return it->second;
+
+    std::uint32_t slot = acquire();
+    glBufferSubData(GL_UNIFORM_BUFFER, slot_offset(slot), sizeof(MaterialBlock), &block);
+    contents[slot] = block;
+    by_value.emplace(block, slot);
+    return slot;
+  }
+
+  std::uint32_t acquire() {
+    if (!free_slots.empty()) {
+      std::uint32_t slot = free_slots.back();
+      free_slots.pop_back();
+      return slot;
+    }
+    if (last_seen.size() == capacity) grow(capacity * 2);
+    last_seen.push_back(0);
+    contents.emplace_back();
+    return static_cast<std::uint32_t>(last_seen.size() - 1);
+  }
+
+  // Reallocates the buffer, keeping the uploaded blocks. Leaves the new
+  // buffer bound to GL_UNIFORM_BUFFER, as sync() expects.
+  void grow(std::uint32_t slots) {
+    GLuint bigger = 0;
+    glGenBuffers(1, &bigger);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, bigger);
+    glBufferData(GL_COPY_WRITE_BUFFER, stride * slots, nullptr, GL_DYNAMIC_DRAW);
+    glBindBuffer(GL_COPY_READ_BUFFER, ubo);
+    glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, stride * capacity);
+    glBindBuffer(GL_COPY_READ_BUFFER, 0);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+    glDeleteBuffers(1, &ubo);
+    ubo = bigger;
+    capacity = slots;
+    glBindBuffer(GL_UNIFORM_BUFFER, ubo);
+  }
+
+  void swap(MaterialBuffer& other) noexcept {
+    std::swap(ubo, other.ubo);
+    std::swap(stride, other.stride);
+    std::swap(capacity, other.capacity);
+    std::swap(frame, other.frame);
+    std::swap(bound_slot, other.bound_slot);
+    last_seen.swap(other.last_seen);
+    free_slots.swap(other.free_slots);
+    contents.swap(other.contents);
+    std::swap(by_value, other.by_value);
+  }
+
+  GLuint ubo = 0;
+  GLsizeiptr stride = 0;
+  std::uint32_t capacity = 0;
+
+  // Frame in which each slot was last claimed; 0 = free
+  std::vector<std::uint64_t> last_seen;
+  std::vector<std::uint32_t> free_slots;
+  // What each slot holds, and the live slots by value
+  std::vector<MaterialBlock> contents;
+  FlatHashMap<MaterialBlock, std::uint32_t, MaterialBlock::Hash> by_value;
+  std::uint64_t frame = 0;
+  std::uint32_t bound_slot = NO_SLOT;
+};
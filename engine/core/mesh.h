@@ -3,25 +3,77 @@
 #include "vertex.h"
 
 #include <vector>
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <memory_resource>
 #include <cstdint>
 #include <iostream>
 
+// Allocator-aware: a Mesh stored in a World gets the world's memory resource
+// (see World::World), so vertex data can live in a per-world arena.
 struct Mesh {
-  std::vector<Vertex> vertices;
-  std::vector<std::uint32_t> indices;
+  using allocator_type = std::pmr::polymorphic_allocator<>;
+
+  std::pmr::vector<Vertex> vertices;
+  std::pmr::vector<std::uint32_t> indices;
 
   Mesh() = default;
-  Mesh(const std::vector<Vertex>& verts, const std::vector<std::uint32_t>& inds)
-    : vertices(verts), indices(inds) {}
+  explicit Mesh(const allocator_type& alloc)
+    : vertices(alloc), indices(alloc) {}
+  Mesh(const Mesh& other, const allocator_type& alloc)
+    : vertices(other.vertices, alloc), indices(other.indices, alloc) {}
+  Mesh(const std::vector<Vertex>& verts, const std::vector<std::uint32_t>& inds,
+       const allocator_type& alloc = {})
+    : vertices(verts.begin(), verts.end(), alloc), indices(inds.begin(), inds.end(), alloc) {}
 };
 
-struct MeshRenderer {
+// Model-space bounds of a mesh's vertices: the AABB, and the sphere around
+// its center that encloses every vertex (used for frustum culling).
+struct MeshBounds {
+    glm::vec3 min = glm::vec3(0.0f);
+    glm::vec3 max = glm::vec3(0.0f);
+    glm::vec3 center = glm::vec3(0.0f);
+    float radius = 0.0f;
+
+    static MeshBounds of(const Mesh& mesh) {
+        MeshBounds b;
+        if (mesh.vertices.empty()) return b;
+
+        b.min = b.max = mesh.vertices.front().position;
+        for (const Vertex& v : mesh.vertices) {
+            b.min = glm::min(b.min, v.position);
+            b.max = glm::max(b.max, v.position);
+        }
+        b.center = (b.min + b.max) * 0.5f;
+
+        float radius_sq = 0.0f;
+        for (const Vertex& v : mesh.vertices) {
+            glm::vec3 d = v.position - b.center;
+            radius_sq = std::max(radius_sq, glm::dot(d, d));
+        }
+        b.radius = std::sqrt(radius_sq);
+        return b;
+    }
+};
+
+// GPU copy of a Mesh: vertex/index buffers and the VAO describing them.
+// Owned through MeshRenderer's shared_ptr, so every entity drawing the same
+// geometry points at one GpuMesh and the renderer can instance them.
+//
+// Besides the vertex attributes (locations 0-2) the VAO takes a per-instance
+// model matrix at locations 3-6, read from the buffer given to
+// draw_instanced().
+struct GpuMesh {
     unsigned int vao = 0;
     unsigned int vbo = 0;
     unsigned int ebo = 0;
     std::uint32_t index_count = 0;
+    // Unique per GpuMesh; the renderer groups draws by it
+    std::uint32_t id = 0;
+    MeshBounds bounds;
 
-    MeshRenderer(const Mesh& mesh) {
+    GpuMesh(const Mesh& mesh) : id(next_id()), bounds(MeshBounds::of(mesh)) {
         index_count = static_cast<std::uint32_t>(mesh.indices.size());
 
         // Generate GPU buffers
@@ -83,18 +135,64 @@ struct MeshRenderer {
             reinterpret_cast<void*>(offsetof(Vertex, texCoord))
         );
 
-        glBindVertexArray(0);
-    }
+        // layout(location = 3) mat4 model, one column per location,
+        // advancing once per instance
+        for (unsigned int column = 0; column < 4; ++column) {
+            glEnableVertexAttribArray(INSTANCE_LOCATION + column);
+            glVertexAttribDivisor(INSTANCE_LOCATION + column, 1);
+        }
 
-    void draw() const {
-        glBindVertexArray(vao);
-        glDrawElements(GL_TRIANGLES, index_count, GL_UNSIGNED_INT, nullptr);
         glBindVertexArray(0);
     }
 
-    ~MeshRenderer() {
+    GpuMesh(const GpuMesh&) = delete;
+    GpuMesh& operator=(const GpuMesh&) = delete;
+
+    ~GpuMesh() {
         if (ebo) glDeleteBuffers(1, &ebo);
         if (vbo) glDeleteBuffers(1, &vbo);
         if (vao) glDeleteVertexArrays(1, &vao);
     }
+
+    // Draws `count` instances whose model matrices are the consecutive
+    // mat4s of `instances` starting at index `first`
+    void draw_instanced(unsigned int instances, std::uint32_t first, std::uint32_t count) const {
+        glBindVertexArray(vao);
+
+        // GL 3.3 has no base instance, so the matrix attributes are
+        // re-pointed at the batch instead
+        glBindBuffer(GL_ARRAY_BUFFER, instances);
+        const std::size_t base = static_cast<std::size_t>(first) * sizeof(float) * 16;
+        for (unsigned int column = 0; column < 4; ++column) {
+            glVertexAttribPointer(
+                INSTANCE_LOCATION + column,
+                4,
+                GL_FLOAT,
+                GL_FALSE,
+                sizeof(float) * 16,
+                reinterpret_cast<void*>(base + column * sizeof(float) * 4)
+            );
+        }
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+        glDrawElementsInstanced(GL_TRIANGLES, index_count, GL_UNSIGNED_INT, nullptr, count);
+        glBindVertexArray(0);
+    }
+
+    static constexpr unsigned int INSTANCE_LOCATION = 3;
+
+private:
+    static std::uint32_t next_id() {
+        static std::uint32_t counter = 0;
+        return ++counter;
+    }
+};
+
+// Copying a MeshRenderer shares its GpuMesh; see create_mesh_instance()
+// (load_object.h) for spawning many entities with the same geometry.
+struct MeshRenderer {
+    std::shared_ptr<GpuMesh> gpu;
+
+    MeshRenderer() = default;
+    MeshRenderer(const Mesh& mesh) : gpu(std::make_shared<GpuMesh>(mesh)) {}
 };
@@ -5,14 +5,18 @@
 #include "transform.h"
 #include "rigidbody.h"
 #include "collision.h"
+#include "significance.h"
+#include "frame_allocator.h"
 
 #include <vector>
+#include <memory_resource>
 #include <iostream>
 
 // PhysicsSystem
 //
 // A minimal physics system that demonstrates:
-//  - explicit Euler integration of `Rigidbody` into `Transform`
+//  - explicit Euler integration of `Rigidbody` into `LocalTransform`, at a
+//    reduced rate for far bodies with a `Significance` component
 //  - a gravity acceleration
 //  - a very simple, naive AABB collision detection and separation step
 //
@@ -28,46 +32,35 @@ public:
 
 	// Run the physics step.
 	// Parameters:
-	// - world: ECS world containing Transform, Rigidbody and Collider components
+	// - world: ECS world containing LocalTransform, Rigidbody and Collider components
 	// - dt: timestep in seconds
 	void run(World& world, float dt) override {
 		if (dt <= 0.0f) return;
 
-		// 1) Integrate forces and velocities (per-body)
-		world.query().for_each<Transform, Rigidbody>([&](Transform& t, Rigidbody& rb) {
-		if (!rb.dynamic) return;
+		// 1) Integrate forces and velocities (per-body). Bodies with a
+		// Significance component step at their bucket's rate, over the time
+		// accumulated since their last step; all others step every frame.
+		world.query<LocalTransform, Rigidbody>().without<Significance>()
+			.for_each<LocalTransform, Rigidbody>([&](LocalTransform& t, Rigidbody& rb) {
+				integrate(t, rb, dt);
+			});
 
-		// Accumulate acceleration from forces: a = F / m
-		glm::vec3 accel = rb.force;
-		if (rb.mass > 0.0f) accel /= rb.mass;
-
-		// Add global gravity
-		accel += gravity;
-
-		// Semi-explicit Euler: v += a * dt; x += v * dt
-		rb.velocity += accel * dt;
-
-		// Apply simple linear damping
-		if (rb.linear_damping > 0.0f) {
-			float damp = std::max(0.0f, 1.0f - rb.linear_damping * dt);
-			rb.velocity *= damp;
-		}
-
-		t.position += rb.velocity * dt;
-
-		// Clear forces for next step (conservative choice)
-		rb.force = glm::vec3(0.0f);
+		for_each_significant<LocalTransform, Rigidbody>(world, [&](Entity, float step, LocalTransform& t, Rigidbody& rb) {
+			integrate(t, rb, step);
 		});
 
 		// 2) Broad+Narrow phase (naive): collect colliders and test all pairs.
-		struct Item { Transform* t; Collider* c; Rigidbody* rb; };
-		std::vector<Item> items;
+		struct Item { LocalTransform* t; Collider* c; Rigidbody* rb; };
+		// Rebuilt every step, so it lives in the system's own arena,
+		// rewound here: worlds stepped by a WorldHost never see begin_frame().
+		scratch.reset();
+		std::pmr::vector<Item> items(&scratch);
 		items.reserve(64);
 
-		world.query().for_each<Transform, Collider>([&](Transform& t, Collider& c) {
+		world.query().for_each<LocalTransform, Collider>([&](LocalTransform& t, Collider& c) {
 		// Try to fetch Rigidbody (optional). We'll use it when resolving.
 		// Note: `World::get` assumes the entity is alive and has the component;
-		// here we only queried Transform+Collider, so Rigidbody may be absent.
+		// here we only queried LocalTransform+Collider, so Rigidbody may be absent.
 		// We detect presence by temporarily attempting to access it through
 		// a try/catch-free approach: query for Rigidbody separately would be
 		// more robust, but for simplicity we capture pointer via reinterpret cast
@@ -100,6 +93,8 @@ public:
 			// We'll conservatively move both by 50% of MTV in opposite directions.
 			A.t->position += -0.5f * mtv;
 			B.t->position +=  0.5f * mtv;
+			A.t->dirty = true;
+			B.t->dirty = true;
 
 			// Velocities: simple bounce using restitution average
 			// (If Rigidbody were present, you'd alter velocities along mtv axis.)
@@ -108,6 +103,35 @@ public:
 	}
 
 	glm::vec3 gravity;
+
+private:
+	FrameArena scratch;
+
+	void integrate(LocalTransform& t, Rigidbody& rb, float dt) const {
+		if (!rb.dynamic || dt <= 0.0f) return;
+
+		// Accumulate acceleration from forces: a = F / m
+		glm::vec3 accel = rb.force;
+		if (rb.mass > 0.0f) accel /= rb.mass;
+
+		// Add global gravity
+		accel += gravity;
+
+		// Semi-explicit Euler: v += a * dt; x += v * dt
+		rb.velocity += accel * dt;
+
+		// Apply simple linear damping
+		if (rb.linear_damping > 0.0f) {
+			float damp = std::max(0.0f, 1.0f - rb.linear_damping * dt);
+			rb.velocity *= damp;
+		}
+
+		t.position += rb.velocity * dt;
+		t.dirty = true;
+
+		// Clear forces for next step (conservative choice)
+		rb.force = glm::vec3(0.0f);
+	}
 };
 
 } // namespace __RUNTIME__
@@ -2,10 +2,9 @@
 
 #include <string>
 #include <memory>
+#include <vector>
+#include <memory_resource>
 #include <iostream>
-#include <unordered_map>
-#include <unordered_set>
-#include <functional>
 
 #include <glad/glad.h>
 #include <glm/glm.hpp>
@@ -15,7 +14,14 @@
 #include "recs/world.h"
 #include "mesh.h"
 #include "transform.h"
+#include "transform_system.h"
 #include "material.h"
+#include "material_buffer.h"
+#include "instance_buffer.h"
+#include "render_queue.h"
+#include "culling.h"
+#include "frame_allocator.h"
+#include "shader.h"
 #include "camera.h"
 #include "time.h"
 #include <recs/entity.h>
@@ -24,9 +30,11 @@ namespace __RUNTIME__ {
 class SystemRenderer {
   public:
 	bool is_editor_view = false;
+	// Optional workers for transform propagation (not owned)
+	ThreadPool* thread_pool = nullptr;
 
 	SystemRenderer()
-	: _program(0), _uMVP(-1)
+	: _uViewProj(-1)
 	{
 		// simple shader sources
 		const char* vs = R"(
@@ -35,12 +43,13 @@ class SystemRenderer {
 		layout (location = 0) in vec3 aPos;
 		layout (location = 1) in vec3 aNormal;
 		layout (location = 2) in vec2 aTexCoord;
+		layout (location = 3) in mat4 aModel;   // per instance
 
-		uniform mat4 u_MVP;
+		uniform mat4 u_ViewProj;
 
 		void main()
 		{
-			gl_Position = u_MVP * vec4(aPos, 1.0);
+			gl_Position = u_ViewProj * aModel * vec4(aPos, 1.0);
 		}
 		)";
 
@@ -49,139 +58,117 @@ class SystemRenderer {
 
 		out vec4 FragColor;
 
-		uniform vec3 u_AlbedoColor;
-		uniform float u_Opacity;
+		layout(std140) uniform MaterialBlock {
+			vec4 u_AlbedoOpacity;   // rgb albedo, a opacity
+			vec4 u_Surface;         // metalic, normal, roughness, ao
+		};
 
 		void main()
 		{
 			// Use material albedo directly (vertex colors not provided by loader)
-			FragColor = vec4(u_AlbedoColor, u_Opacity);
+			FragColor = u_AlbedoOpacity;
 		}
 		)";
 
-		auto compile = [](GLenum type, const char* src)->GLuint {
-			GLuint s = glCreateShader(type);
-			glShaderSource(s, 1, &src, nullptr);
-			glCompileShader(s);
-			GLint ok = 0; glGetShaderiv(s, GL_COMPILE_STATUS, &ok);
-			if (!ok) {
-			GLint len = 0; glGetShaderiv(s, GL_INFO_LOG_LENGTH, &len);
-			std::string log(len, '\0');
-			glGetShaderInfoLog(s, len, nullptr, &log[0]);
-			std::cerr << "Shader compile error: " << log << std::endl;
-			}
-			return s;
-		};
-
-		GLuint vsid = compile(GL_VERTEX_SHADER, vs);
-		GLuint fsid = compile(GL_FRAGMENT_SHADER, fs);
-		_program = glCreateProgram();
-		glAttachShader(_program, vsid);
-		glAttachShader(_program, fsid);
-		glLinkProgram(_program);
-		GLint ok = 0; glGetProgramiv(_program, GL_LINK_STATUS, &ok);
-		if (!ok) {
-			GLint len = 0; glGetProgramiv(_program, GL_INFO_LOG_LENGTH, &len);
-			std::string log(len, '\0');
-			glGetProgramInfoLog(_program, len, nullptr, &log[0]);
-			std::cerr << "Program link error: " << log << std::endl;
-		}
-		glDeleteShader(vsid); glDeleteShader(fsid);
-
-		_uMVP = glGetUniformLocation(_program, "u_MVP");
+		_shader = ShaderProgram(vs, fs);
+		_shader.bind_uniform_block("MaterialBlock", MaterialBuffer::BINDING);
+		_uViewProj = _shader.uniform("u_ViewProj");
 
 		// default camera
 		_proj = glm::perspective(glm::radians(45.0f), 800.0f/600.0f, 0.1f, 100.0f);
 		_view = glm::lookAt(glm::vec3(0.0f,0.0f,3.0f), glm::vec3(0.0f), glm::vec3(0.0f,1.0f,0.0f));
 	}
 
-	~SystemRenderer() {
-		if (_program) glDeleteProgram(_program);
-	}
-
 	void render_frame(World& _world) {
 		// Ensure transforms are up-to-date before rendering
 		update_system(_world, 0.0f);
 
-		glUseProgram(_program);
-
-		_world.query().for_each<Transform, Mesh, MeshRenderer, Material, Identity>(
-			[&](Transform& transform, Mesh& _mesh, MeshRenderer& mesh_renderer, Material& material, Identity& identity) {
-			// Use already computed world matrix
-			glm::mat4 model = transform.world;
-
-			glm::mat4 mvp = _proj * _view * model;
-			glUniformMatrix4fv(_uMVP, 1, GL_FALSE, glm::value_ptr(mvp));
-
-			// === MATERIAL BINDING ===
-			glUniform3fv(
-				glGetUniformLocation(_program, "u_AlbedoColor"),
-				1,
-				glm::value_ptr(material.albedo_color)
-			);
-
-			glUniform1f(
-				glGetUniformLocation(_program, "u_Opacity"),
-				material.opacity
-			);
-
-			mesh_renderer.draw();
+		// Upload new / changed materials; draws below only bind them
+		_materials.sync(_world);
+
+		_batches = 0;
+
+		// Only entities whose bounds touch the view frustum are drawn
+		const glm::mat4 view = _view;
+		const glm::mat4 view_proj = _proj * view;
+		_visible = cull_renderables(_world, view_proj, thread_pool);
+
+		// One packet per draw, ordered by its draw key (render_queue.h):
+		// opaque first, grouped by material and mesh and front to back
+		// within a group, then transparent back to front
+		std::pmr::vector<DrawPacket> packets(FrameAllocator::resource());
+		packets.reserve(_visible);
+		_world.query().for_each<WorldMatrix, MeshRenderer, Material, WorldBounds>(
+			[&](WorldMatrix& world_matrix, MeshRenderer& mesh_renderer, Material& material, WorldBounds& bounds) {
+				if (!bounds.visible || !mesh_renderer.gpu) return;
+				const GpuMesh* mesh = mesh_renderer.gpu.get();
+
+				// View-space distance of the entity's origin along the view axis
+				const glm::vec4& origin = world_matrix.value[3];
+				const float depth = -(view[0][2] * origin.x + view[1][2] * origin.y +
+				                      view[2][2] * origin.z + view[3][2]);
+
+				const std::uint64_t key = material.opacity < 1.0f
+					? draw_key::transparent(SHADER_ID, material.gpu_slot, mesh->id, depth)
+					: draw_key::opaque(SHADER_ID, material.gpu_slot, mesh->id, depth);
+				packets.push_back({key, mesh, &world_matrix.value, material.gpu_slot});
 			}
 		);
-		glUseProgram(0);
-	}
-
-  void update_system(World& world, float /*delta_time*/) {
-		// Rebuild local matrices and initialize world = local
-		world.query().for_each_entity<Transform>(
-			[&](Entity e, Transform& t) {
-				t.rebuild_local();
-				t.world = t.local;
+		if (packets.empty()) return;
+
+		sort_draw_packets(packets);
+
+		std::pmr::vector<glm::mat4> matrices(FrameAllocator::resource());
+		matrices.reserve(packets.size());
+		for (const DrawPacket& packet : packets) matrices.push_back(*packet.model);
+		_instances.upload(matrices.data(), matrices.size());
+
+		_shader.use();
+		ShaderProgram::set(_uViewProj, view_proj);
+
+		bool blending = false;
+		for (std::size_t first = 0; first < packets.size();) {
+			const DrawPacket& head = packets[first];
+
+			// Consecutive packets with the same mesh and material (and pass)
+			// become one instanced draw
+			std::size_t last = first + 1;
+			while (last < packets.size() &&
+			       packets[last].mesh == head.mesh &&
+			       packets[last].material == head.material &&
+			       draw_key::pass(packets[last].key) == draw_key::pass(head.key)) {
+				++last;
 			}
-		);
 
-		// Build a small map of Family components so we can traverse children lists
-		std::unordered_map<std::uint32_t, Family> family_map;
-		world.query().for_each_entity<Family>(
-			[&](Entity e, Family& f) {
-				family_map[e.index] = f;
+			if (!blending && draw_key::pass(head.key) == draw_key::Transparent) {
+				glEnable(GL_BLEND);
+				glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+				glDepthMask(GL_FALSE);
+				blending = true;
 			}
-		);
 
-		// Helper recursive lambda to propagate world transform to children
-		std::function<void(Entity)> propagate = [&](Entity parent) {
-			auto it = family_map.find(parent.index);
-			if (it == family_map.end()) return;
-			for (const Entity& child : it->second.children) {
-				if (!world.alive(child)) continue;
-				// ensure child has Transform
-				// apply parent's world * child's local
-				auto& parent_t = world.get<Transform>(parent);
-				auto& child_t = world.get<Transform>(child);
-				child_t.world = parent_t.world * child_t.local;
-				// recurse
-				propagate(child);
-			}
-		};
+			// === MATERIAL BINDING ===
+			_materials.bind(head.material);
+			head.mesh->draw_instanced(_instances.id(),
+				static_cast<std::uint32_t>(first), static_cast<std::uint32_t>(last - first));
 
-		// Find root transforms (entities that are not listed as a child of anyone)
-		// We'll treat any Transform whose entity index is not a child in any Family as a root.
-		std::unordered_set<std::uint32_t> child_set;
-		for (const auto& kv : family_map) {
-			for (const Entity& c : kv.second.children) child_set.insert(c.index);
+			++_batches;
+			first = last;
 		}
 
-		world.query().for_each_entity<Transform>(
-			[&](Entity e, Transform& t) {
-				if (child_set.find(e.index) == child_set.end()) {
-					// root -> propagate down its hierarchy
-					propagate(e);
-				}
-			}
-		);
+		if (blending) {
+			glDepthMask(GL_TRUE);
+			glDisable(GL_BLEND);
+		}
+		glUseProgram(0);
+	}
 
-    world.query().for_each<Transform, Camera, Identity>(
-      [&](Transform& transform, Camera& camera, Identity& identity) {
+  void update_system(World& world, float /*delta_time*/) {
+		// Only changed transforms and their subtrees are recomputed
+		propagate_transforms(world, thread_pool);
+
+    world.query().for_each<LocalTransform, Camera, Identity>(
+      [&](LocalTransform& transform, Camera& camera, Identity& identity) {
 				if (!is_editor_view) {
 					// ============================
 					// CLAMP PITCH (ANTI GIMBAL LOCK)
@@ -258,9 +245,21 @@ class SystemRenderer {
     _proj = proj;
   }
 
+	// Instanced draw calls issued by the last render_frame
+	std::size_t batch_count() const noexcept { return _batches; }
+	// Entities that passed frustum culling in the last render_frame
+	std::size_t visible_count() const noexcept { return _visible; }
+
   private:
-	GLuint _program;
-	GLint _uMVP;
+	// Draw-key shader field of the one program the renderer has
+	static constexpr std::uint32_t SHADER_ID = 0;
+
+	ShaderProgram _shader;
+	MaterialBuffer _materials;
+	InstanceBuffer _instances;
+	GLint _uViewProj;
+	std::size_t _batches = 0;
+	std::size_t _visible = 0;
 	glm::mat4 _view, _proj;
 };
 };
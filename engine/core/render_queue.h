@@ -0,0 +1,113 @@
+#pragma once
+
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory_resource>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "mesh.h"
+
+// Render queue
+//
+// Every frame the renderer turns each visible entity into a DrawPacket
+// whose 64-bit key encodes where the draw belongs in the frame, radix-sorts
+// the packets by key, and walks them in order. Key layout, most significant
+// bits first:
+//
+//   opaque:       pass:2 | shader:6 | material:16 | mesh:16 | depth:24
+//   transparent:  pass:2 | ~depth:24 | shader:6 | material:16 | mesh:16
+//
+// Opaque draws are grouped by state (fewest program / material / VAO
+// changes, and runs of equal mesh+material become one instanced draw), then
+// front to back within a group so early depth testing rejects hidden
+// fragments. Transparent draws must blend back to front, so the inverted
+// depth leads and state only breaks ties.
+//
+// Material slots and mesh ids are truncated to 16 bits. A collision only
+// interleaves two groups in the order; packets keep the full values, so
+// batching stays correct.
+namespace draw_key {
+
+enum Pass : std::uint64_t {
+  Opaque = 0,
+  Transparent = 1,
+};
+
+constexpr std::uint64_t DEPTH_MASK = (1ull << 24) - 1;
+
+// 24 bits that order non-negative view depths: the top bits of an IEEE
+// float are monotonic in its value, so no near/far range is needed
+inline std::uint64_t quantize_depth(float depth) {
+  if (!(depth > 0.0f)) return 0;  // behind the eye, or NaN
+  return std::bit_cast<std::uint32_t>(depth) >> 8;
+}
+
+inline std::uint64_t opaque(std::uint32_t shader, std::uint32_t material,
+                            std::uint32_t mesh, float depth) {
+  return (std::uint64_t(Opaque) << 62)
+       | (std::uint64_t(shader & 0x3f) << 56)
+       | (std::uint64_t(material & 0xffff) << 40)
+       | (std::uint64_t(mesh & 0xffff) << 24)
+       | quantize_depth(depth);
+}
+
+inline std::uint64_t transparent(std::uint32_t shader, std::uint32_t material,
+                                 std::uint32_t mesh, float depth) {
+  return (std::uint64_t(Transparent) << 62)
+       | ((DEPTH_MASK - quantize_depth(depth)) << 38)
+       | (std::uint64_t(shader & 0x3f) << 32)
+       | (std::uint64_t(material & 0xffff) << 16)
+       | std::uint64_t(mesh & 0xffff);
+}
+
+inline Pass pass(std::uint64_t key) { return static_cast<Pass>(key >> 62); }
+
+} // namespace draw_key
+
+struct DrawPacket {
+  std::uint64_t key;
+  const GpuMesh* mesh;
+  const glm::mat4* model;
+  std::uint32_t material;  // MaterialBuffer slot
+};
+
+// Stable LSD radix sort of packets by key, one byte per pass. All eight
+// histograms are built in a single read of the keys, and passes whose byte
+// is the same for every packet (e.g. the pass bits in an all-opaque frame)
+// are skipped. The scratch buffer comes from the packets' own allocator.
+inline void sort_draw_packets(std::pmr::vector<DrawPacket>& packets) {
+  const std::size_t n = packets.size();
+  if (n < 2) return;
+
+  std::size_t counts[8][256];
+  std::memset(counts, 0, sizeof(counts));
+  for (const DrawPacket& p : packets) {
+    for (int byte = 0; byte < 8; ++byte) ++counts[byte][(p.key >> (byte * 8)) & 0xff];
+  }
+
+  std::pmr::vector<DrawPacket> scratch(n, packets.get_allocator());
+  DrawPacket* src = packets.data();
+  DrawPacket* dst = scratch.data();
+
+  for (int byte = 0; byte < 8; ++byte) {
+    std::size_t* count = counts[byte];
+    if (count[(src[0].key >> (byte * 8)) & 0xff] == n) continue;
+
+    std::size_t offset = 0;
+    for (std::size_t bucket = 0; bucket < 256; ++bucket) {
+      std::size_t c = count[bucket];
+      count[bucket] = offset;
+      offset += c;
+    }
+    for (std::size_t i = 0; i < n; ++i) {
+      dst[count[(src[i].key >> (byte * 8)) & 0xff]++] = src[i];
+    }
+    std::swap(src, dst);
+  }
+
+  if (src != packets.data()) packets.swap(scratch);
+}
@@ -0,0 +1,164 @@
+#pragma once
+
+#include <string>
+#include <utility>
+#include <iostream>
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+#include "recs/flat_hash_map.h"
+
+// ShaderProgram
+//
+// Owns a linked GL program and, right after linking, reflects its active
+// uniforms and uniform blocks into lookup tables. Resolve the locations a
+// draw loop needs once (e.g. in the renderer's constructor) and keep the
+// GLint; `uniform()` is a table lookup, never a glGetUniformLocation call.
+//
+// Move-only; the program is deleted with the object.
+class ShaderProgram {
+public:
+  ShaderProgram() = default;
+
+  ShaderProgram(const char* vertex_src, const char* fragment_src) {
+    GLuint vs = compile(GL_VERTEX_SHADER, vertex_src);
+    GLuint fs = compile(GL_FRAGMENT_SHADER, fragment_src);
+
+    program = glCreateProgram();
+    glAttachShader(program, vs);
+    glAttachShader(program, fs);
+    glLinkProgram(program);
+    glDeleteShader(vs);
+    glDeleteShader(fs);
+
+    GLint ok = 0;
+    glGetProgramiv(program, GL_LINK_STATUS, &ok);
+    if (!ok) {
+      GLint len = 0;
+      glGetProgramiv(program, GL_INFO_LOG_LENGTH, &len);
+      std::string log(len, '\0');
+      glGetProgramInfoLog(program, len, nullptr, &log[0]);
+      std::cerr << "Program link error: " << log << std::endl;
+      return;
+    }
+
+    reflect();
+  }
+
+  ~ShaderProgram() {
+    if (program) glDeleteProgram(program);
+  }
+
+  ShaderProgram(const ShaderProgram&) = delete;
+  ShaderProgram& operator=(const ShaderProgram&) = delete;
+
+  ShaderProgram(ShaderProgram&& other) noexcept
+    : program(std::exchange(other.program, 0)),
+      uniforms(std::move(other.uniforms)),
+      blocks(std::move(other.blocks)) {}
+
+  ShaderProgram& operator=(ShaderProgram&& other) noexcept {
+    if (this != &other) {
+      if (program) glDeleteProgram(program);
+      program = std::exchange(other.program, 0);
+      uniforms = std::move(other.uniforms);
+      blocks = std::move(other.blocks);
+    }
+    return *this;
+  }
+
+  GLuint id() const noexcept { return program; }
+  bool valid() const noexcept { return program != 0; }
+
+  void use() const { glUseProgram(program); }
+
+  // Location of an active uniform, or -1 if the program has none by that
+  // name (unused uniforms are optimized out by the driver). Arrays are
+  // listed under their base name.
+  GLint uniform(const std::string& name) const {
+    auto it = uniforms.find(name);
+    return it != uniforms.end() ? it->second : -1;
+  }
+
+  // Index of an active uniform block, or GL_INVALID_INDEX
+  GLuint uniform_block(const std::string& name) const {
+    auto it = blocks.find(name);
+    return it != blocks.end() ? it->second : GL_INVALID_INDEX;
+  }
+
+  // Points the named block at a GL_UNIFORM_BUFFER binding point
+  void bind_uniform_block(const std::string& name, GLuint binding) const {
+    GLuint index = uniform_block(name);
+    if (index != GL_INVALID_INDEX) glUniformBlockBinding(program, index, binding);
+  }
+
+  // Setters for a cached location; the program must be in use
+  static void set(GLint location, const glm::mat4& value) {
+    glUniformMatrix4fv(location, 1, GL_FALSE, glm::value_ptr(value));
+  }
+  static void set(GLint location, const glm::vec3& value) {
+    glUniform3fv(location, 1, glm::value_ptr(value));
+  }
+  static void set(GLint location, float value) { glUniform1f(location, value); }
+  static void set(GLint location, int value) { glUniform1i(location, value); }
+
+private:
+  static GLuint compile(GLenum type, const char* src) {
+    GLuint s = glCreateShader(type);
+    glShaderSource(s, 1, &src, nullptr);
+    glCompileShader(s);
+    GLint ok = 0;
+    glGetShaderiv(s, GL_COMPILE_STATUS, &ok);
+    if (!ok) {
+      GLint len = 0;
+      glGetShaderiv(s, GL_INFO_LOG_LENGTH, &len);
+      std::string log(len, '\0');
+      glGetShaderInfoLog(s, len, nullptr, &log[0]);
+      std::cerr << "Shader compile error: " << log << std::endl;
+    }
+    return s;
+  }
+
+  void reflect() {
+    GLint count = 0;
+    GLint max_len = 0;
+    glGetProgramiv(program, GL_ACTIVE_UNIFORMS, &count);
+    glGetProgramiv(program, GL_ACTIVE_UNIFORM_MAX_LENGTH, &max_len);
+
+    std::string name(static_cast<std::size_t>(max_len) + 1, '\0');
+    for (GLint i = 0; i < count; ++i) {
+      GLsizei len = 0;
+      GLint size = 0;
+      GLenum type = 0;
+      glGetActiveUniform(program, static_cast<GLuint>(i), max_len, &len, &size, &type, &name[0]);
+
+      std::string key(name.data(), static_cast<std::size_t>(len));
+      // Members of uniform blocks have no location; they are reached
+      // through the block
+      GLint location = glGetUniformLocation(program, key.c_str());
+      if (location < 0) continue;
+
+      // "lights[0]" -> "lights"
+      if (key.size() > 3 && key.compare(key.size() - 3, 3, "[0]") == 0) {
+        key.resize(key.size() - 3);
+      }
+      uniforms[key] = location;
+    }
+
+    glGetProgramiv(program, GL_ACTIVE_UNIFORM_BLOCKS, &count);
+    glGetProgramiv(program, GL_ACTIVE_UNIFORM_BLOCK_MAX_NAME_LENGTH, &max_len);
+
+    name.assign(static_cast<std::size_t>(max_len) + 1, '\0');
+    for (GLint i = 0; i < count; ++i) {
+      GLsizei len = 0;
+      glGetActiveUniformBlockName(program, static_cast<GLuint>(i), max_len, &len, &name[0]);
+      blocks[std::string(name.data(), static_cast<std::size_t>(len))] = static_cast<GLuint>(i);
+    }
+  }
+
+  GLuint program = 0;
+  FlatHashMap<std::string, GLint> uniforms;
+  FlatHashMap<std::string, GLuint> blocks;
+};
@@ -0,0 +1,96 @@
+#pragma once
+
+#include "recs/world.h"
+#include "recs/system.h"
+#include "transform.h"
+#include "camera.h"
+
+#include <cstdint>
+
+// Significance component
+//
+// Marks an entity whose update rate may drop with distance to the active
+// camera. SignificanceSystem assigns it a bucket every frame:
+//
+//   bucket 0: every frame   bucket 2: every 4th frame
+//   bucket 1: every 2nd     bucket 3: every 8th frame
+//
+// Entities in the same bucket are staggered by entity index, so a reduced
+// rate spreads the work evenly over frames instead of bunching it. Only
+// entities with a WorldMatrix (add_transform) are bucketed.
+struct Significance {
+  // Assigned by SignificanceSystem; read-only for everyone else.
+  std::uint8_t bucket = 0;
+  bool active = true;        // true on frames this entity should update
+  float distance = 0.0f;     // to the camera, in world units
+  float delta_time = 0.0f;   // time since the previous active frame
+
+  // Time accumulated while inactive.
+  float pending_time = 0.0f;
+
+  Significance() = default;
+};
+
+namespace __RUNTIME__ {
+
+class SignificanceSystem : public System {
+public:
+  static constexpr int BUCKET_COUNT = 4;
+
+  // Upper distance bound of buckets 0..2; anything farther is bucket 3.
+  float bucket_distance[BUCKET_COUNT - 1] = { 25.0f, 50.0f, 100.0f };
+
+  void run(World& world, float dt) override {
+    ++frame;
+
+    // The first WorldMatrix + Camera entity is the active camera. Without
+    // one, everything stays at full rate. Distances are between world-space
+    // positions, so parented cameras and entities measure correctly; this
+    // runs before propagation, so they lag a frame behind LocalTransform.
+    bool has_camera = false;
+    glm::vec3 eye(0.0f);
+    world.query().for_each<WorldMatrix, Camera>([&](WorldMatrix& m, Camera&) {
+      if (has_camera) return;
+      has_camera = true;
+      eye = glm::vec3(m.value[3]);
+    });
+
+    world.query().for_each_entity<WorldMatrix, Significance>(
+      [&](Entity e, WorldMatrix& m, Significance& s) {
+        s.distance = has_camera ? glm::length(glm::vec3(m.value[3]) - eye) : 0.0f;
+
+        std::uint8_t bucket = 0;
+        while (bucket < BUCKET_COUNT - 1 && s.distance > bucket_distance[bucket]) ++bucket;
+        s.bucket = has_camera ? bucket : 0;
+
+        std::uint32_t period_mask = (1u << s.bucket) - 1u;
+        s.pending_time += dt;
+        s.active = ((frame + e.index) & period_mask) == 0;
+        if (s.active) {
+          s.delta_time = s.pending_time;
+          s.pending_time = 0.0f;
+        }
+      });
+  }
+
+  std::uint64_t frame_index() const noexcept { return frame; }
+
+private:
+  std::uint64_t frame = 0;
+};
+
+// Query filter for rate-limited systems: runs fn(entity, dt, components...)
+// only for entities whose Significance is active this frame, with the time
+// elapsed since their previous update. Entities without Significance are
+// not visited; iterate them separately if they must run every frame (see
+// PhysicsSystem).
+template<typename... Components, typename Func>
+void for_each_significant(World& world, Func&& fn) {
+  world.query().for_each_entity<Significance, Components...>(
+    [&](Entity e, Significance& s, Components&... components) {
+      if (!s.active) return;
+      fn(e, s.delta_time, components...);
+    });
+}
+
+} // namespace __RUNTIME__
@@ -2,39 +2,146 @@
 
 #include "glm/glm.hpp"
 #include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/quaternion.hpp>
+#include "trs_kernel.h"
+#include <algorithm>
+#include <cstdint>
+#include <cmath>
+#include <cstddef>
 
-struct Transform {
+// Transform components
+//
+// A transform is split by who reads it, so each system streams only the
+// bytes it uses:
+//
+//  - LocalTransform: position / rotation / scale and the dirty flag. This
+//    is what gameplay, physics and the editor write (40 bytes).
+//  - LocalMatrix: TRS composed into a matrix by transform propagation.
+//  - WorldMatrix: parent world * local; what the renderer reads.
+//  - WorldBounds (renderables only): world-space bounding sphere, updated
+//    with WorldMatrix.
+//
+// add_transform() (transform_system.h) attaches all three. Entities that
+// want quaternion rotation also add LocalRotation, which then replaces
+// LocalTransform::rotation.
+
+struct LocalTransform {
   glm::vec3 position = {0.0f, 0.0f, 0.0f};
-  glm::vec3 rotation = {0.0f, 0.0f, 0.0f};
+  glm::vec3 rotation = {0.0f, 0.0f, 0.0f};  // Euler angles in degrees (X, Y, Z)
   glm::vec3 scale = {1.0f, 1.0f, 1.0f};
 
-  // Local matrix built from position/rotation/scale (local space)
-  glm::mat4 local = glm::mat4(1.0f);
-  // World transform after applying parent transforms
-  glm::mat4 world = glm::mat4(1.0f);
-
-  // Mark when local changed and world needs recompute
+  // Set after changing position/rotation/scale (or the parent); transform
+  // propagation rebuilds the matrices and clears it
   bool dirty = true;
 
-  Transform() = default;
-  Transform(glm::vec3 pos, glm::vec3 rot, glm::vec3 scl)
-    : position(pos), rotation(rot), scale(scl) {
-    dirty = true;
-  }
-
-  // Rebuild local matrix from TRS
-  void rebuild_local() {
-    glm::mat4 m(1.0f);
-    m = glm::translate(m, position);
-    m = glm::rotate(m, glm::radians(rotation.x), glm::vec3(1,0,0));
-    m = glm::rotate(m, glm::radians(rotation.y), glm::vec3(0,1,0));
-    m = glm::rotate(m, glm::radians(rotation.z), glm::vec3(0,0,1));
-    m = glm::scale(m, scale);
-    local = m;
-    dirty = true;
-  }
+  LocalTransform() = default;
+  LocalTransform(glm::vec3 pos, glm::vec3 rot, glm::vec3 scl)
+    : position(pos), rotation(rot), scale(scl) {}
+};
+
+// Optional quaternion rotation, used instead of LocalTransform::rotation.
+// Set LocalTransform::dirty after changing it.
+struct LocalRotation {
+  glm::quat value = glm::quat(1.0f, 0.0f, 0.0f, 0.0f);
+};
+
+struct LocalMatrix {
+  glm::mat4 value = glm::mat4(1.0f);
+};
+
+struct WorldMatrix {
+  glm::mat4 value = glm::mat4(1.0f);
+};
+
+// World-space bounding sphere of a renderable, and whether it survived the
+// last frustum cull. Transform propagation moves the model-space sphere
+// into world space whenever it rewrites the entity's WorldMatrix, so
+// static geometry costs nothing per frame; set LocalTransform::dirty after
+// changing the model sphere. The loaders in load_object.h add it from the
+// mesh's MeshBounds.
+struct WorldBounds {
+  glm::vec3 center = glm::vec3(0.0f);
+  float radius = 0.0f;
+  std::uint8_t visible = 1;
+
+  glm::vec3 model_center = glm::vec3(0.0f);
+  float model_radius = 0.0f;
+
+  WorldBounds() = default;
+  WorldBounds(glm::vec3 center, float radius)
+    : model_center(center), model_radius(radius) {}
 };
 
+static_assert(sizeof(WorldBounds) % sizeof(float) == 0,
+              "sphere_batch strides in whole floats");
+
+// Recomputes b's world sphere under model matrix m. The largest axis scale
+// keeps the sphere enclosing under non-uniform scale.
+inline void update_world_bounds(WorldBounds& b, const glm::mat4& m) {
+  const float scale_sq = std::max({ glm::dot(glm::vec3(m[0]), glm::vec3(m[0])),
+                                    glm::dot(glm::vec3(m[1]), glm::vec3(m[1])),
+                                    glm::dot(glm::vec3(m[2]), glm::vec3(m[2])) });
+  b.center = glm::vec3(m * glm::vec4(b.model_center, 1.0f));
+  b.radius = b.model_radius * std::sqrt(scale_sq);
+}
+
+static_assert(sizeof(LocalTransform) % sizeof(float) == 0,
+              "trs_batch strides in whole floats");
+
+// compose_trs view over parallel LocalTransform / LocalMatrix arrays
+inline TrsBatch trs_batch(const LocalTransform* t, LocalMatrix* out) {
+  TrsBatch batch;
+  batch.position = &t->position.x;
+  batch.rotation = &t->rotation.x;
+  batch.scale = &t->scale.x;
+  batch.in_stride = sizeof(LocalTransform) / sizeof(float);
+  batch.matrix = &out->value[0][0];
+  batch.out_stride = sizeof(LocalMatrix) / sizeof(float);
+  return batch;
+}
+
+// T * Rx * Ry * Rz * S for a single transform, through the batched kernel
+inline glm::mat4 compose_local(const LocalTransform& t) {
+  LocalMatrix m;
+  compose_trs(trs_batch(&t, &m), 1);
+  return m.value;
+}
+
+// T * R(q) * S for transforms with a LocalRotation
+inline glm::mat4 compose_local(const LocalTransform& t, const LocalRotation& r) {
+  glm::mat4 m = glm::mat4_cast(r.value);
+  m[0] *= t.scale.x;
+  m[1] *= t.scale.y;
+  m[2] *= t.scale.z;
+  m[3] = glm::vec4(t.position, 1.0f);
+  return m;
+}
+
+// Spread the low 21 bits of v so that two zero bits separate each bit.
+inline std::uint64_t morton_spread(std::uint64_t v) {
+  v &= 0x1fffff;
+  v = (v | v << 32) & 0x1f00000000ffffull;
+  v = (v | v << 16) & 0x1f0000ff0000ffull;
+  v = (v | v << 8)  & 0x100f00f00f00f00full;
+  v = (v | v << 4)  & 0x10c30c30c30c30c3ull;
+  v = (v | v << 2)  & 0x1249249249249249ull;
+  return v;
+}
+
+// 63-bit Morton (Z-order) code of a position quantized to `cell_size`.
+// Sorting rows by it, e.g. world.sort_by_key<LocalTransform>(...), keeps
+// spatially close entities close in chunk memory.
+inline std::uint64_t morton_code(const glm::vec3& p, float cell_size = 1.0f) {
+  auto quantize = [&](float v) -> std::uint64_t {
+    float q = std::floor(v / cell_size) + 1048576.0f;  // 2^20 bias for negatives
+    q = q < 0.0f ? 0.0f : (q > 2097151.0f ? 2097151.0f : q);
+    return static_cast<std::uint64_t>(q);
+  };
+  return morton_spread(quantize(p.x))
+       | morton_spread(quantize(p.y)) << 1
+       | morton_spread(quantize(p.z)) << 2;
+}
+
 struct Velocity {
   float x = 0;
   float y = 0;
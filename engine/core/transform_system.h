@@ -0,0 +1,230 @@
+#pragma once
+
+#include "recs/world.h"
+#include "recs/system.h"
+#include "recs/flat_hash_map.h"
+#include "recs/thread_pool.h"
+#include "transform.h"
+#include "trs_kernel.h"
+#include "frame_allocator.h"
+
+#include <atomic>
+#include <memory_resource>
+
+// Transform propagation
+//
+// Brings LocalMatrix and WorldMatrix up to date from LocalTransform,
+// touching only what changed since the last pass:
+//
+//  - LocalMatrix is rebuilt for transforms flagged `dirty`, in batches
+//    through the SIMD TRS kernel (trs_kernel.h)
+//  - WorldMatrix is recomputed for dirty transforms and everything below
+//    them in the Family hierarchy; clean subtrees keep their matrices
+//  - WorldBounds, where present, follows each rewritten WorldMatrix
+//  - all flags are cleared afterwards
+//
+// A frame in which nothing moved costs one scan over the dirty flags. Code
+// that writes position/rotation/scale (or reparents an entity) must set
+// `dirty = true` for the change to be picked up.
+//
+// Has no GL dependency, so headless simulations can run it as a System.
+namespace __RUNTIME__ {
+
+// Gives `e` the three transform components; the ones it already has are
+// left untouched.
+inline void add_transform(World& world, Entity e) {
+  world.add<LocalTransform>(e);
+  world.add<LocalMatrix>(e);
+  world.add<WorldMatrix>(e);
+}
+
+// Runs fn(begin, end) over [0, count): batched on `pool` when there is one,
+// inline otherwise.
+template<typename Fn>
+inline void run_batches(ThreadPool* pool, std::size_t count, std::size_t grain, Fn&& fn) {
+  if (count == 0) return;
+  if (!pool || count <= grain) {
+    fn(std::size_t(0), count);
+    return;
+  }
+  pool->parallel_for(count, grain, fn);
+}
+
+// With a pool, each phase is split over its workers: local matrices and
+// roots per chunk, then the hierarchy one depth level at a time, so every
+// parent is final before any of its children read it.
+//
+// Transient tables come from `scratch`, by default the calling thread's
+// frame arena, which only rewinds when the main loop calls
+// FrameAllocator::begin_frame(). Callers outside that loop pass their own.
+inline void propagate_transforms(World& world, ThreadPool* pool = nullptr,
+                                 std::pmr::memory_resource* scratch = nullptr) {
+  // Transient tables: no heap traffic once the arena has grown. They are
+  // built on this thread; workers only read them.
+  std::pmr::memory_resource* frame = scratch ? scratch : FrameAllocator::resource();
+
+  // 1) Local matrices of changed transforms only. Runs of consecutive dirty
+  // rows go through the batched TRS kernel in one call; after a bulk move
+  // that is usually the whole chunk.
+  std::pmr::vector<Chunk*> chunks(frame);
+  world.query<LocalTransform, LocalMatrix, WorldMatrix>()
+    .collect_chunks<LocalTransform, LocalMatrix, WorldMatrix>(chunks);
+
+  std::atomic<std::size_t> changed{ 0 };
+  run_batches(pool, chunks.size(), 1, [&](std::size_t begin, std::size_t end) {
+    for (std::size_t c = begin; c < end; ++c) {
+      auto [transforms, locals] = chunks[c]->get_arrays<LocalTransform, LocalMatrix>();
+      std::size_t count = chunks[c]->size();
+      std::size_t rebuilt = 0;
+
+      std::size_t row = 0;
+      while (row < count) {
+        if (!transforms[row].dirty) { ++row; continue; }
+
+        std::size_t run_end = row + 1;
+        while (run_end < count && transforms[run_end].dirty) ++run_end;
+        compose_trs(trs_batch(transforms + row, locals + row), run_end - row);
+        rebuilt += run_end - row;
+        row = run_end;
+      }
+      if (rebuilt) changed.fetch_add(rebuilt, std::memory_order_relaxed);
+    }
+  });
+  if (changed.load() == 0) return;
+
+  // Chunks that also carry WorldBounds: their spheres are moved along with
+  // every WorldMatrix rewritten below, and only then
+  PmrFlatHashSet<Chunk*> bounded(frame);
+  {
+    std::pmr::vector<Chunk*> with_bounds(frame);
+    world.query<LocalTransform, WorldMatrix, WorldBounds>()
+      .collect_chunks<LocalTransform, WorldMatrix, WorldBounds>(with_bounds);
+    for (Chunk* chunk : with_bounds) bounded.insert(chunk);
+  }
+
+  // Quaternion rotations replace the Euler result
+  world.query<LocalTransform, LocalRotation, LocalMatrix>()
+    .for_each<LocalTransform, LocalRotation, LocalMatrix>(
+      [](LocalTransform& t, LocalRotation& r, LocalMatrix& m) {
+        if (t.dirty) m.value = compose_local(t, r);
+      }
+    );
+
+  // Map entity index -> Family so we can traverse children lists. The
+  // pointers stay valid because nothing migrates during this pass.
+  struct Node {
+    Entity entity;
+    const Family* family;
+  };
+  PmrFlatHashMap<std::uint32_t, Node> family_map(frame);
+  world.query<Family>().for_each_entity<Family>(
+    [&](Entity e, Family& f) {
+      if (!f.children.empty()) family_map[e.index] = { e, &f };
+    }
+  );
+
+  // Roots are transforms that are not listed as a child of anyone
+  PmrFlatHashSet<std::uint32_t> child_set(frame);
+  for (const auto& kv : family_map) {
+    for (const Entity& c : kv.second.family->children) child_set.insert(c.index);
+  }
+
+  // One depth level of the hierarchy. `changed` carries "an ancestor's
+  // world matrix moved" down the tree.
+  struct Pending {
+    Entity entity;
+    const glm::mat4* parent_world;
+    bool parent_changed;
+    // Filled in when the level runs, read when the next one is built
+    const glm::mat4* world;
+    bool changed;
+  };
+  std::pmr::vector<Pending> level(frame);
+  std::pmr::vector<Pending> next(frame);
+
+  auto push_children = [&](Entity parent, const glm::mat4* parent_world, bool parent_changed) {
+    auto it = family_map.find(parent.index);
+    if (it == family_map.end() || it->second.entity != parent) return;
+    for (const Entity& child : it->second.family->children) {
+      if (world.alive(child)) next.push_back({ child, parent_world, parent_changed, nullptr, false });
+    }
+  };
+
+  // First level below the roots. Built before the roots run, while their
+  // dirty flags still say whether they moved.
+  for (const auto& kv : family_map) {
+    if (child_set.contains(kv.first)) continue;
+    Entity root = kv.second.entity;
+    if (!world.alive(root)) continue;
+    push_children(root, &world.get<WorldMatrix>(root).value, world.get<LocalTransform>(root).dirty);
+  }
+
+  // 2) Roots, per chunk
+  run_batches(pool, chunks.size(), 1, [&](std::size_t begin, std::size_t end) {
+    for (std::size_t c = begin; c < end; ++c) {
+      Chunk* chunk = chunks[c];
+      auto [transforms, locals, worlds] =
+        chunk->get_arrays<LocalTransform, LocalMatrix, WorldMatrix>();
+      WorldBounds* bounds =
+        bounded.contains(chunk) ? std::get<0>(chunk->get_arrays<WorldBounds>()) : nullptr;
+      std::size_t count = chunk->size();
+
+      for (std::size_t row = 0; row < count; ++row) {
+        if (!transforms[row].dirty) continue;
+        if (child_set.contains(chunk->entity_ids[row].index)) continue;
+        worlds[row].value = locals[row].value;
+        if (bounds) update_world_bounds(bounds[row], worlds[row].value);
+        transforms[row].dirty = false;
+      }
+    }
+  });
+
+  // 3) Remaining levels, parents before children
+  constexpr std::size_t NODE_GRAIN = 1024;
+  while (!next.empty()) {
+    level.swap(next);
+    next.clear();
+
+    run_batches(pool, level.size(), NODE_GRAIN, [&](std::size_t begin, std::size_t end) {
+      for (std::size_t i = begin; i < end; ++i) {
+        Pending& node = level[i];
+        auto& t = world.get<LocalTransform>(node.entity);
+        auto& world_m = world.get<WorldMatrix>(node.entity);
+
+        node.changed = node.parent_changed || t.dirty;
+        if (node.changed) {
+          world_m.value = *node.parent_world * world.get<LocalMatrix>(node.entity).value;
+          if (world.has<WorldBounds>(node.entity)) {
+            update_world_bounds(world.get<WorldBounds>(node.entity), world_m.value);
+          }
+        }
+        t.dirty = false;
+        node.world = &world_m.value;
+      }
+    });
+
+    for (const Pending& node : level) {
+      push_children(node.entity, node.world, node.changed);
+    }
+  }
+}
+
+// Propagation as a System. `pool` may be the WorldHost's own pool: the
+// worlds it steps then share its workers (parallel_for is safe to call
+// from inside a worker). Scratch tables come from an arena of its own,
+// rewound every run, so a host that never calls begin_frame() stays bounded.
+class TransformSystem : public System {
+public:
+  explicit TransformSystem(ThreadPool* pool = nullptr) : pool(pool) {}
+
+  void run(World& world, float /*dt*/) override {
+    scratch.reset();
+    propagate_transforms(world, pool, &scratch);
+  }
+
+private:
+  ThreadPool* pool;
+  FrameArena scratch;
+};
+
+} // namespace __RUNTIME__
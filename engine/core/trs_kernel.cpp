@@ -0,0 +1,231 @@
+#include "trs_kernel.h"
+
+#include <cmath>
+#include <cstdint>
+
+#if defined(__AVX2__)
+  #include <immintrin.h>
+  #define CRUX_TRS_AVX2 1
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+  #include <emmintrin.h>
+  #define CRUX_TRS_SSE2 1
+#endif
+
+namespace {
+
+constexpr float DEG_TO_RAD = 0.017453292519943295f;
+constexpr float TWO_OVER_PI = 0.6366197723675814f;
+
+// pi/2 split in three parts (Cody-Waite) so r = x - j*pi/2 stays exact
+// for the angle range transforms use
+constexpr float PIO2_1 = 1.5703125f;
+constexpr float PIO2_2 = 4.837512969970703125e-4f;
+constexpr float PIO2_3 = 7.54978995489188216e-8f;
+
+// Minimax coefficients on [-pi/4, pi/4] (Cephes sinf/cosf)
+constexpr float SIN_1 = -1.6666654611e-1f;
+constexpr float SIN_2 = 8.3321608736e-3f;
+constexpr float SIN_3 = -1.9515295891e-4f;
+constexpr float COS_1 = 4.166664568298827e-2f;
+constexpr float COS_2 = -1.388731625493765e-3f;
+constexpr float COS_3 = 2.443315711809948e-5f;
+
+// Lane types. Each provides arithmetic, a strided gather, a store, rounding
+// and the quadrant fix-up of sincos; the kernel below is written once
+// against them.
+
+struct F1 {
+  static constexpr std::size_t WIDTH = 1;
+  float v;
+
+  F1() = default;
+  explicit F1(float x) : v(x) {}
+
+  static F1 load(const float* p, std::size_t) { return F1(*p); }
+  void store(float* out) const { out[0] = v; }
+
+  friend F1 operator+(F1 a, F1 b) { return F1(a.v + b.v); }
+  friend F1 operator-(F1 a, F1 b) { return F1(a.v - b.v); }
+  friend F1 operator*(F1 a, F1 b) { return F1(a.v * b.v); }
+  friend F1 operator-(F1 a) { return F1(-a.v); }
+
+  friend F1 round_nearest(F1 a) { return F1(std::nearbyint(a.v)); }
+
+  // j is the (integral) quadrant; sp/cp are sin/cos of the reduced angle
+  friend void fix_quadrant(F1 j, F1 sp, F1 cp, F1& s, F1& c) {
+    int q = static_cast<int>(j.v) & 3;
+    float sv = (q & 1) ? cp.v : sp.v;
+    float cv = (q & 1) ? sp.v : cp.v;
+    s = F1((q & 2) ? -sv : sv);
+    c = F1(((q + 1) & 2) ? -cv : cv);
+  }
+};
+
+#if defined(CRUX_TRS_SSE2)
+struct F4 {
+  static constexpr std::size_t WIDTH = 4;
+  __m128 v;
+
+  F4() = default;
+  explicit F4(__m128 x) : v(x) {}
+  explicit F4(float x) : v(_mm_set1_ps(x)) {}
+
+  static F4 load(const float* p, std::size_t stride) {
+    return F4(_mm_setr_ps(p[0], p[stride], p[2 * stride], p[3 * stride]));
+  }
+  void store(float* out) const { _mm_storeu_ps(out, v); }
+
+  friend F4 operator+(F4 a, F4 b) { return F4(_mm_add_ps(a.v, b.v)); }
+  friend F4 operator-(F4 a, F4 b) { return F4(_mm_sub_ps(a.v, b.v)); }
+  friend F4 operator*(F4 a, F4 b) { return F4(_mm_mul_ps(a.v, b.v)); }
+  friend F4 operator-(F4 a) { return F4(_mm_xor_ps(a.v, _mm_set1_ps(-0.0f))); }
+
+  // cvtps rounds to nearest under the default MXCSR mode
+  friend F4 round_nearest(F4 a) { return F4(_mm_cvtepi32_ps(_mm_cvtps_epi32(a.v))); }
+
+  friend void fix_quadrant(F4 j, F4 sp, F4 cp, F4& s, F4& c) {
+    __m128i q = _mm_cvtps_epi32(j.v);
+    __m128i one = _mm_set1_epi32(1);
+    __m128i two = _mm_set1_epi32(2);
+
+    __m128 swap = _mm_castsi128_ps(_mm_cmpeq_epi32(_mm_and_si128(q, one), one));
+    __m128 sv = _mm_or_ps(_mm_and_ps(swap, cp.v), _mm_andnot_ps(swap, sp.v));
+    __m128 cv = _mm_or_ps(_mm_and_ps(swap, sp.v), _mm_andnot_ps(swap, cp.v));
+
+    // Bit 1 of q (resp. q + 1) moved to the sign bit
+    __m128 s_sign = _mm_castsi128_ps(_mm_slli_epi32(_mm_and_si128(q, two), 30));
+    __m128 c_sign = _mm_castsi128_ps(
+      _mm_slli_epi32(_mm_and_si128(_mm_add_epi32(q, one), two), 30)
+    );
+    s = F4(_mm_xor_ps(sv, s_sign));
+    c = F4(_mm_xor_ps(cv, c_sign));
+  }
+};
+#endif
+
+#if defined(CRUX_TRS_AVX2)
+struct F8 {
+  static constexpr std::size_t WIDTH = 8;
+  __m256 v;
+
+  F8() = default;
+  explicit F8(__m256 x) : v(x) {}
+  explicit F8(float x) : v(_mm256_set1_ps(x)) {}
+
+  static F8 load(const float* p, std::size_t stride) {
+    const int s = static_cast<int>(stride);
+    __m256i index = _mm256_mullo_epi32(
+      _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7), _mm256_set1_epi32(s)
+    );
+    return F8(_mm256_i32gather_ps(p, index, 4));
+  }
+  void store(float* out) const { _mm256_storeu_ps(out, v); }
+
+  friend F8 operator+(F8 a, F8 b) { return F8(_mm256_add_ps(a.v, b.v)); }
+  friend F8 operator-(F8 a, F8 b) { return F8(_mm256_sub_ps(a.v, b.v)); }
+  friend F8 operator*(F8 a, F8 b) { return F8(_mm256_mul_ps(a.v, b.v)); }
+  friend F8 operator-(F8 a) { return F8(_mm256_xor_ps(a.v, _mm256_set1_ps(-0.0f))); }
+
+  friend F8 round_nearest(F8 a) {
+    return F8(_mm256_round_ps(a.v, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC));
+  }
+
+  friend void fix_quadrant(F8 j, F8 sp, F8 cp, F8& s, F8& c) {
+    __m256i q = _mm256_cvtps_epi32(j.v);
+    __m256i one = _mm256_set1_epi32(1);
+    __m256i two = _mm256_set1_epi32(2);
+
+    __m256 swap = _mm256_castsi256_ps(_mm256_cmpeq_epi32(_mm256_and_si256(q, one), one));
+    __m256 sv = _mm256_blendv_ps(sp.v, cp.v, swap);
+    __m256 cv = _mm256_blendv_ps(cp.v, sp.v, swap);
+
+    __m256 s_sign = _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_and_si256(q, two), 30));
+    __m256 c_sign = _mm256_castsi256_ps(
+      _mm256_slli_epi32(_mm256_and_si256(_mm256_add_epi32(q, one), two), 30)
+    );
+    s = F8(_mm256_xor_ps(sv, s_sign));
+    c = F8(_mm256_xor_ps(cv, c_sign));
+  }
+};
+#endif
+
+template<typename F>
+inline void sincos(F x, F& s, F& c) {
+  F j = round_nearest(x * F(TWO_OVER_PI));
+  F r = x - j * F(PIO2_1) - j * F(PIO2_2) - j * F(PIO2_3);
+  F z = r * r;
+
+  F sp = r + r * z * (F(SIN_1) + z * (F(SIN_2) + z * F(SIN_3)));
+  F cp = F(1.0f) - z * F(0.5f) + z * z * (F(COS_1) + z * (F(COS_2) + z * F(COS_3)));
+  fix_quadrant(j, sp, cp, s, c);
+}
+
+// Composes F::WIDTH matrices starting at element `first`.
+template<typename F>
+inline void compose_lanes(const TrsBatch& b, std::size_t first) {
+  constexpr std::size_t W = F::WIDTH;
+  const std::size_t stride = b.in_stride;
+  const float* pos = b.position + first * stride;
+  const float* rot = b.rotation + first * stride;
+  const float* scl = b.scale + first * stride;
+
+  F sa, ca, sb, cb, sc, cc;
+  sincos(F::load(rot + 0, stride) * F(DEG_TO_RAD), sa, ca);
+  sincos(F::load(rot + 1, stride) * F(DEG_TO_RAD), sb, cb);
+  sincos(F::load(rot + 2, stride) * F(DEG_TO_RAD), sc, cc);
+
+  F sx = F::load(scl + 0, stride);
+  F sy = F::load(scl + 1, stride);
+  F sz = F::load(scl + 2, stride);
+
+  // R = Rx(a) * Ry(b) * Rz(c), columns scaled by S
+  F sa_sb = sa * sb;
+  F ca_sb = ca * sb;
+
+  float lanes[12][W];
+  (cb * cc * sx).store(lanes[0]);
+  ((sa_sb * cc + ca * sc) * sx).store(lanes[1]);
+  ((sa * sc - ca_sb * cc) * sx).store(lanes[2]);
+
+  (-(cb * sc) * sy).store(lanes[3]);
+  ((ca * cc - sa_sb * sc) * sy).store(lanes[4]);
+  ((sa * cc + ca_sb * sc) * sy).store(lanes[5]);
+
+  (sb * sz).store(lanes[6]);
+  (-(sa * cb) * sz).store(lanes[7]);
+  (ca * cb * sz).store(lanes[8]);
+
+  F::load(pos + 0, stride).store(lanes[9]);
+  F::load(pos + 1, stride).store(lanes[10]);
+  F::load(pos + 2, stride).store(lanes[11]);
+
+  for (std::size_t l = 0; l < W; ++l) {
+    float* m = b.matrix + (first + l) * b.out_stride;
+    m[0]  = lanes[0][l];  m[1]  = lanes[1][l];  m[2]  = lanes[2][l];  m[3]  = 0.0f;
+    m[4]  = lanes[3][l];  m[5]  = lanes[4][l];  m[6]  = lanes[5][l];  m[7]  = 0.0f;
+    m[8]  = lanes[6][l];  m[9]  = lanes[7][l];  m[10] = lanes[8][l];  m[11] = 0.0f;
+    m[12] = lanes[9][l];  m[13] = lanes[10][l]; m[14] = lanes[11][l]; m[15] = 1.0f;
+  }
+}
+
+} // namespace
+
+void compose_trs(const TrsBatch& batch, std::size_t count) {
+  std::size_t i = 0;
+#if defined(CRUX_TRS_AVX2)
+  for (; i + 8 <= count; i += 8) compose_lanes<F8>(batch, i);
+#elif defined(CRUX_TRS_SSE2)
+  for (; i + 4 <= count; i += 4) compose_lanes<F4>(batch, i);
+#endif
+  for (; i < count; ++i) compose_lanes<F1>(batch, i);
+}
+
+const char* compose_trs_path() {
+#if defined(CRUX_TRS_AVX2)
+  return "avx2";
+#elif defined(CRUX_TRS_SSE2)
+  return "sse2";
+#else
+  return "scalar";
+#endif
+}
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <cstddef>
+
+// Batched TRS -> matrix kernel
+//
+// Builds `T * Rx * Ry * Rz * S` (Euler angles in degrees) for many
+// transforms at once. The rotation is written out in closed form and the
+// six sines/cosines come from a polynomial sincos, so one pass over eight
+// (AVX2) or four (SSE2) lanes replaces five glm matrix products per
+// transform.
+//
+// Inputs and outputs are strided so the kernel reads straight out of
+// component arrays: element i's position is `position + i * in_stride`
+// (same for rotation/scale) and its column-major matrix is written to
+// `matrix + i * out_stride`. Strides are in floats.
+//
+// The widest instruction set enabled at compile time is used (build with
+// -mavx2 or -march=native for the 8-wide path); the remainder and non-x86
+// builds go through the scalar path, which uses the same polynomials.
+struct TrsBatch {
+  const float* position = nullptr;
+  const float* rotation = nullptr;  // degrees
+  const float* scale = nullptr;
+  std::size_t in_stride = 3;
+
+  float* matrix = nullptr;
+  std::size_t out_stride = 16;
+};
+
+void compose_trs(const TrsBatch& batch, std::size_t count);
+
+// Which path compose_trs was compiled with: "avx2", "sse2" or "scalar".
+const char* compose_trs_path();
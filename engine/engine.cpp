@@ -96,6 +96,13 @@ namespace __ENGINE__ {
 
 
 
+    //
+    // Bucket entities with a Significance component by distance to the
+    // camera so rate-limited systems can skip far ones. Runs first so the
+    // buckets are current for every system after it.
+    //
+    world.add_system < __RUNTIME__::SignificanceSystem > ();
+
     //
     // Add the physics system to the world.
     // This system handles basic rigidbody integration and naive collision detection.
@@ -108,6 +115,7 @@ namespace __ENGINE__ {
     // The SystemRenderer is responsible for drawing all entities that have renderable components.
     //
     renderer = __RUNTIME__::SystemRenderer();
+    renderer.thread_pool = &thread_pool;
   }
 
   void CruxEngine::update() {
@@ -115,6 +123,7 @@ namespace __ENGINE__ {
     // FRAME TIMING
     // ============================
     Time::update_deltatime();
+    FrameAllocator::begin_frame();
 
     glClearColor(0.12f, 0.12f, 0.12f, 1.0f);
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
@@ -5,11 +5,13 @@
 #include <glad/glad.h>
 #include <GLFW/glfw3.h>
 #include <recs/world.h>
+#include <recs/thread_pool.h>
 #include <string>
 
 #include "core/error.h"
 #include "core/input.h"
 #include "core/physics_system.h"
+#include "core/significance.h"
 #include "core/render.h"
 #include "core/time.h"
 
@@ -40,6 +42,10 @@ class CruxEngine {
   // The World manages all entities, components, and systems.
   //
   World world = World();
+  //
+  // Workers for data-parallel engine passes (transform propagation).
+  //
+  ThreadPool thread_pool;
 };
 
 };
@@ -3,7 +3,9 @@
 #include "../core/mesh.h"
 #include "../core/vertex.h"
 #include "../core/transform.h"
+#include "../core/transform_system.h"
 #include "../core/material.h"
+#include "../core/culling.h"
 #include "recs/world.h"
 #include <fstream>
 #include <sstream>
@@ -169,11 +171,11 @@ static void load_obj_mesh(std::ifstream& file, Mesh& mesh, std::string& name) {
 static Entity create_entity_from_mesh(World& world, const Mesh& mesh, std::string name) {
     Entity entity = world.create_entity();
     assert(world.alive(entity));
-    world.add<Transform>(entity);
+    __RUNTIME__::add_transform(world, entity);
     world.add<Mesh>(entity);
     world.get<Mesh>(entity) = mesh;
     
-    // center mesh vertices around origin (model-space) so Transform.position controls world placement
+    // center mesh vertices around origin (model-space) so LocalTransform.position controls world placement
     if (!world.get<Mesh>(entity).vertices.empty()) {
         glm::vec3 centroid(0.0f);
         for (const auto& v : world.get<Mesh>(entity).vertices) centroid += v.position;
@@ -185,16 +187,18 @@ static Entity create_entity_from_mesh(World& world, const Mesh& mesh, std::strin
     world.add<Material>(entity);
 
     // add an identity so every entity has a name/tag/layer
-    world.add<Identity>(entity);
-    world.get<Identity>(entity) = Identity(name);
+    world.emplace<Identity>(entity, name);
 
     // Construct MeshRenderer in-place using the (now centered) mesh reference
     // Do this after adding Material/Identity to avoid extra moves that can
     // complicate component addresses during creation.
     world.emplace<MeshRenderer>(entity, world.get<Mesh>(entity));
+    const MeshBounds mesh_bounds = world.get<MeshRenderer>(entity).gpu->bounds;
+    world.emplace<WorldBounds>(entity, mesh_bounds.center, mesh_bounds.radius);
 
-    // ensure Transform starts at origin (mesh already centered)
-    world.get<Transform>(entity).position = {0.0f, 0.0f, 0.0f};
+    // ensure LocalTransform starts at origin (mesh already centered)
+    world.get<LocalTransform>(entity).position = {0.0f, 0.0f, 0.0f};
+    world.get<LocalTransform>(entity).dirty = true;
     // debug: print first vertex for diagnosis
     if (!world.get<Mesh>(entity).vertices.empty()) {
         const auto& fv = world.get<Mesh>(entity).vertices.front();
@@ -203,6 +207,27 @@ static Entity create_entity_from_mesh(World& world, const Mesh& mesh, std::strin
     return entity;
 }
 
+// New entity drawing the same geometry and material as `source` (which
+// needs a MeshRenderer), with its own transform. The GPU mesh is shared
+// rather than re-uploaded, so the renderer instances all copies in one
+// draw call. The CPU-side Mesh stays on `source` only.
+static Entity create_mesh_instance(World& world, Entity source) {
+    Entity entity = world.create_entity();
+    assert(world.alive(entity));
+    __RUNTIME__::add_transform(world, entity);
+    // Copied out first: adding components moves `entity` between chunks
+    Material material = world.get<Material>(source);
+    MeshRenderer mesh_renderer = world.get<MeshRenderer>(source);
+    StringId name = world.get<Identity>(source).name;
+
+    world.emplace<Material>(entity, material);
+    world.emplace<Identity>(entity, name);
+    const MeshBounds mesh_bounds = mesh_renderer.gpu->bounds;
+    world.emplace<MeshRenderer>(entity, std::move(mesh_renderer));
+    world.emplace<WorldBounds>(entity, mesh_bounds.center, mesh_bounds.radius);
+    return entity;
+}
+
 static Entity create_entities_from_obj(World& world, const std::string& filepath) {
     std::vector<Entity> entities;
 
@@ -210,7 +235,7 @@ static Entity create_entities_from_obj(World& world, const std::string& filepath
     if (!file.is_open()) {
         Entity e = world.create_entity();
         assert(world.alive(e));
-        world.add<Transform>(e);
+        __RUNTIME__::add_transform(world, e);
         std::cerr << "[I/O ERROR] ==> Failed to open file: " << filepath << "\n";
         return e;
     }
@@ -230,30 +255,25 @@ static Entity create_entities_from_obj(World& world, const std::string& filepath
         if (entities.empty()) {
             auto e = world.create_entity();
             assert(world.alive(e));
-            world.add<Transform>(e);
-            world.add<Identity>(e);
-            world.get<Identity>(e) = Identity("EmptyObject");
+            __RUNTIME__::add_transform(world, e);
+            world.emplace<Identity>(e, "EmptyObject");
             return e;
         } else if (entities.size() > 1) {
             auto e = world.create_entity();
             assert(world.alive(e));
-            world.add<Transform>(e);
+            __RUNTIME__::add_transform(world, e);
             std::filesystem::path p(filepath);
             
             // add family and identity to parent
             world.add<Family>(e);
-            world.add<Identity>(e);
-            world.get<Identity>(e).name = p.filename().string();
 
             // set parent identity name from filepath (basename)
-            std::string base = filepath;
-            auto pos = base.find_last_of("/\\");
-            if (pos != std::string::npos) base = base.substr(pos + 1);
-            world.get<Identity>(e) = Identity(base);
+            world.emplace<Identity>(e, p.filename().string());
 
                 for (auto child : entities) {
                     // set child's parent to the parent entity
                     world.get<Family>(child).parent = e;
+                    world.get<LocalTransform>(child).dirty = true;  // now relative to `e`
                     // add child to parent's children list
                     world.get<Family>(e).children.push_back(child);
                     // MeshRenderer already created in create_entity_from_mesh; avoid